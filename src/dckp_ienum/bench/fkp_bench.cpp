@@ -0,0 +1,179 @@
+/*
+FKP bound benchmark.
+Evaluates the Dantzig bound of random subproblems (first free item, fixed profit and weight) on each instance,
+with a linear scan from the first free item and with solve_fkp_fast, both searching from scratch and from
+the critical item of the parent subproblem (as B&B and ienum do), checks that all give the same FkpResult
+and reports the time per bound.
+
+Usage: fkp_bench [-r queries] [-l] input...
+With -l, each input is an instance list (as in dckp_ienum -l).
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dckp_ienum/fkp_solver.hpp>
+#include <dckp_ienum/instance.hpp>
+
+using namespace dckp_ienum;
+
+// Reference: the greedy fill one item at a time
+static FkpResult fkp_linear(const Instance& instance, item_index_t jp1, int_profit_t fixed_p, int_weight_t fixed_w) {
+    FkpResult ans;
+    ans.weight = fixed_w;
+    ans.profit = fixed_p;
+    ans.fractional_idx = instance.num_items();
+
+    for (item_index_t i = jp1; i < instance.num_items(); ++i) {
+        if (ans.weight >= instance.capacity()) {
+            ans.fractional_idx = i;
+            break;
+        }
+
+        int_profit_t p = instance.profit(i);
+        if (p <= 0) {
+            ans.fractional_idx = i;
+            break;
+        }
+
+        int_weight_t w = instance.weight(i);
+        int_weight_t new_w = ans.weight + w;
+
+        if (new_w <= instance.capacity()) {
+            ans.profit += p;
+            ans.weight = new_w;
+        } else {
+            dckp_ienum::float_t fraction = static_cast<dckp_ienum::float_t>(instance.capacity() - ans.weight) / static_cast<dckp_ienum::float_t>(w);
+            ans.ub = ans.profit + static_cast<int_profit_t>(fraction * static_cast<dckp_ienum::float_t>(p));
+            ans.fractional_idx = i;
+            return ans;
+        }
+    }
+
+    ans.ub = ans.profit;
+    return ans;
+}
+
+static bool operator==(const FkpResult& a, const FkpResult& b) {
+    return a.fractional_idx == b.fractional_idx && a.ub == b.ub && a.profit == b.profit && a.weight == b.weight;
+}
+
+struct Query {
+    item_index_t jp1;
+    int_profit_t fixed_p;
+    int_weight_t fixed_w;
+    item_index_t parent_critical;   // fractional_idx of the bound of the parent node (item jp1-1 not fixed yet)
+};
+
+template <typename F>
+static double seconds_per_query(const std::vector<Query>& queries, F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const Query& q : queries) {
+        f(q);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / queries.size();
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t num_queries = 100000;
+    bool list = false;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            num_queries = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "-l") == 0) {
+            list = true;
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if (paths.empty() || num_queries == 0) {
+        std::cerr << "Usage: " << argv[0] << " [-r queries] [-l] input..." << std::endl;
+        return 1;
+    }
+
+    if (list) {
+        std::vector<std::filesystem::path> instances;
+        for (const auto& list_path : paths) {
+            std::ifstream file(list_path);
+            std::string line;
+            while (std::getline(file, line)) {
+                if (not line.empty()) {
+                    instances.push_back(list_path.parent_path() / line);
+                }
+            }
+        }
+        paths = std::move(instances);
+    }
+
+    std::cout << std::left << std::setw(40) << "instance" << std::right
+        << std::setw(8) << "n"
+        << std::setw(14) << "linear ns"
+        << std::setw(14) << "search ns"
+        << std::setw(14) << "hinted ns"
+        << std::setw(10) << "speedup" << std::endl;
+
+    bool all_same = true;
+    for (const auto& path : paths) {
+        Instance instance;
+        instance.parse(path);
+        instance.sort_items();
+
+        // Subproblems like the ones of a search: the items before jp1 fixed, each taken with probability 1/2 if it fits
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<item_index_t> jp1_dist(0, instance.num_items());
+        std::bernoulli_distribution take(0.5);
+        std::vector<Query> queries(num_queries);
+        for (Query& q : queries) {
+            q.jp1 = jp1_dist(rng);
+            q.fixed_p = 0;
+            q.fixed_w = 0;
+            q.parent_critical = invalid_v<item_index_t>;
+            for (item_index_t i = 0; i < q.jp1; ++i) {
+                if (i + 1 == q.jp1) {
+                    q.parent_critical = fkp_linear(instance, i, q.fixed_p, q.fixed_w).fractional_idx;
+                }
+                if (q.fixed_w + instance.weight(i) <= instance.capacity() && take(rng)) {
+                    q.fixed_p += instance.profit(i);
+                    q.fixed_w += instance.weight(i);
+                }
+            }
+        }
+
+        // The search must give the same result with or without a hint, wherever it points
+        for (const Query& q : queries) {
+            const FkpResult expected = fkp_linear(instance, q.jp1, q.fixed_p, q.fixed_w);
+            const item_index_t hint = jp1_dist(rng);
+            if (not (solve_fkp_fast(instance, q.jp1, q.fixed_p, q.fixed_w) == expected && solve_fkp_fast(instance, q.jp1, q.fixed_p, q.fixed_w, hint) == expected)) {
+                std::cerr << path << ": results differ for jp1 = " << q.jp1 << ", p = " << q.fixed_p << ", w = " << q.fixed_w << std::endl;
+                all_same = false;
+                break;
+            }
+        }
+
+        int_profit_t sink = 0;
+        double linear = seconds_per_query(queries, [&](const Query& q) { sink += fkp_linear(instance, q.jp1, q.fixed_p, q.fixed_w).ub; });
+        double search = seconds_per_query(queries, [&](const Query& q) { sink += solve_fkp_fast(instance, q.jp1, q.fixed_p, q.fixed_w).ub; });
+        double hinted = seconds_per_query(queries, [&](const Query& q) { sink += solve_fkp_fast(instance, q.jp1, q.fixed_p, q.fixed_w, q.parent_critical).ub; });
+
+        std::cout << std::left << std::setw(40) << path.filename().string() << std::right << std::fixed << std::setprecision(1)
+            << std::setw(8) << instance.num_items()
+            << std::setw(14) << linear * 1e9
+            << std::setw(14) << search * 1e9
+            << std::setw(14) << hinted * 1e9
+            << std::setw(10) << linear / std::min(search, hinted)
+            << (sink == 42? " " : "") << std::endl;
+    }
+
+    return all_same? 0 : 1;
+}
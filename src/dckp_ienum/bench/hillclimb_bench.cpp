@@ -0,0 +1,114 @@
+/*
+Hillclimb neighbourhood benchmark.
+Runs the hillclimb solver with the full and the incremental neighbourhood evaluation on each instance
+and reports the average cost of an iteration (one applied move).
+
+Usage: hillclimb_bench [-t seconds] [-l] input...
+Each run stops after the given time (default 60s), the per-iteration cost is measured over the moves applied until then.
+With -l, each input is an instance list (as in dckp_ienum -l).
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dckp_ienum/dckp_hillclimb_solver.hpp>
+#include <dckp_ienum/instance.hpp>
+
+using namespace dckp_ienum;
+
+struct RunResult {
+    std::size_t iterations;
+    double seconds;
+    int_profit_t profit;
+    bool timed_out;
+};
+
+static RunResult run(const Instance& instance, HillclimbNeighbourhood neighbourhood, double timeout_s) {
+    Solution soln;
+    soln.x.resize(instance.num_items());
+
+    std::atomic<bool> stop = false;
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+
+    HillclimbStats stats = solve_dckp_hillclimb(instance, soln, &stop, [&](const Solution&) {
+        if (elapsed() > timeout_s) {
+            stop = true;
+        }
+    }, HillclimbParams { neighbourhood });
+
+    return { stats.adds + stats.swaps, elapsed(), soln.p, stop.load() };
+}
+
+int main(int argc, char* argv[]) {
+    double timeout_s = 60;
+    bool list = false;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            timeout_s = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "-l") == 0) {
+            list = true;
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if (paths.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [-t seconds] [-l] input..." << std::endl;
+        return 1;
+    }
+
+    if (list) {
+        std::vector<std::filesystem::path> instances;
+        for (const auto& list_path : paths) {
+            std::ifstream file(list_path);
+            std::string line;
+            while (std::getline(file, line)) {
+                if (not line.empty()) {
+                    instances.push_back(list_path.parent_path() / line);
+                }
+            }
+        }
+        paths = std::move(instances);
+    }
+
+    std::cout << std::left << std::setw(40) << "instance" << std::right
+        << std::setw(8) << "n"
+        << std::setw(8) << "iters"
+        << std::setw(14) << "full us/it"
+        << std::setw(14) << "incr us/it"
+        << std::setw(10) << "speedup"
+        << std::setw(10) << "same" << std::endl;
+
+    for (const auto& path : paths) {
+        Instance instance;
+        instance.parse(path);
+        instance.sort_items();
+
+        RunResult full = run(instance, HillclimbNeighbourhood::Full, timeout_s);
+        RunResult incremental = run(instance, HillclimbNeighbourhood::Incremental, timeout_s);
+
+        auto per_iteration_us = [](const RunResult& r) { return r.seconds * 1e6 / std::max<std::size_t>(r.iterations, 1); };
+
+        // Only comparable if both runs reached the local optimum
+        const char* same = (full.timed_out || incremental.timed_out)? "-" : (full.profit == incremental.profit? "yes" : "NO");
+
+        std::cout << std::left << std::setw(40) << path.filename().string() << std::right << std::fixed << std::setprecision(2)
+            << std::setw(8) << instance.num_items()
+            << std::setw(8) << full.iterations
+            << std::setw(14) << per_iteration_us(full)
+            << std::setw(14) << per_iteration_us(incremental)
+            << std::setw(10) << per_iteration_us(full) / per_iteration_us(incremental)
+            << std::setw(10) << same << std::endl;
+    }
+}
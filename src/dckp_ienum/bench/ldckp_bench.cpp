@@ -0,0 +1,147 @@
+/*
+LDCKP bound benchmark.
+Computes the Lagrangian bound of random subproblems (the items before jp1 fixed) on each instance,
+solving the fractional knapsack of each subgradient iteration by sorting (as the ldckp_fkp_solver section did)
+and by partitioning, and reports the time per bound and the largest difference between the two bounds.
+The bounds may differ slightly as items with the same ratio can be taken in a different order, which changes
+the subgradient.
+
+Usage: ldckp_bench [-r queries] [-k iterations] [-l] input...
+With -l, each input is an instance list (as in dckp_ienum -l).
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dckp_ienum/conflicts.hpp>
+#include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/ldckp_solver.hpp>
+
+using namespace dckp_ienum;
+
+struct Query {
+    Bitset fixed;
+    item_index_t jp1;
+    int_profit_t fixed_p;
+    int_weight_t fixed_w;
+};
+
+template <typename F>
+static double seconds_per_query(const std::vector<Query>& queries, F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const Query& q : queries) {
+        f(q);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / queries.size();
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t num_queries = 100;
+    std::size_t k_max = LdckpSolverParams {}.k_max;
+    bool list = false;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            num_queries = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            k_max = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "-l") == 0) {
+            list = true;
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if (paths.empty() || num_queries == 0 || k_max == 0) {
+        std::cerr << "Usage: " << argv[0] << " [-r queries] [-k iterations] [-l] input..." << std::endl;
+        return 1;
+    }
+
+    if (list) {
+        std::vector<std::filesystem::path> instances;
+        for (const auto& list_path : paths) {
+            std::ifstream file(list_path);
+            std::string line;
+            while (std::getline(file, line)) {
+                if (not line.empty()) {
+                    instances.push_back(list_path.parent_path() / line);
+                }
+            }
+        }
+        paths = std::move(instances);
+    }
+
+    std::cout << std::left << std::setw(40) << "instance" << std::right
+        << std::setw(8) << "n"
+        << std::setw(14) << "sort us"
+        << std::setw(14) << "partition us"
+        << std::setw(10) << "speedup"
+        << std::setw(12) << "max diff" << std::endl;
+
+    LdckpSolverParams sort_params;
+    sort_params.k_max = k_max;
+    sort_params.fkp = LdckpFkpAlgorithm::Sort;
+
+    LdckpSolverParams partition_params = sort_params;
+    partition_params.fkp = LdckpFkpAlgorithm::Partition;
+
+    for (const auto& path : paths) {
+        Instance instance;
+        instance.parse(path);
+        instance.sort_items();
+
+        // Subproblems like the ones of B&B: the items before jp1 fixed, each taken with probability 1/2 if feasible
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<item_index_t> jp1_dist(0, instance.num_items() - 1);
+        std::bernoulli_distribution take(0.5);
+        std::vector<Query> queries(num_queries);
+        for (Query& q : queries) {
+            q.jp1 = jp1_dist(rng);
+            q.fixed_p = 0;
+            q.fixed_w = 0;
+            q.fixed.resize(instance.num_items());
+            for (item_index_t i = 0; i < q.jp1; ++i) {
+                bool feasible = q.fixed_w + instance.weight(i) <= instance.capacity();
+                for (item_index_t j : instance.backward_conflicts(i)) {
+                    feasible = feasible && not q.fixed[j];
+                }
+                if (feasible && take(rng)) {
+                    q.fixed[i] = true;
+                    q.fixed_p += instance.profit(i);
+                    q.fixed_w += instance.weight(i);
+                }
+            }
+        }
+
+        std::vector<dckp_ienum::float_t> sort_ub, partition_ub;
+        double sort = seconds_per_query(queries, [&](const Query& q) {
+            sort_ub.push_back(solve_ldckp(instance, q.fixed, q.jp1, q.fixed_p, q.fixed_w, sort_params).ub);
+        });
+        double partition = seconds_per_query(queries, [&](const Query& q) {
+            partition_ub.push_back(solve_ldckp(instance, q.fixed, q.jp1, q.fixed_p, q.fixed_w, partition_params).ub);
+        });
+
+        dckp_ienum::float_t max_diff = 0;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            max_diff = std::max(max_diff, std::abs(sort_ub[i] - partition_ub[i]));
+        }
+
+        std::cout << std::left << std::setw(40) << path.filename().string() << std::right << std::fixed << std::setprecision(1)
+            << std::setw(8) << instance.num_items()
+            << std::setw(14) << sort * 1e6
+            << std::setw(14) << partition * 1e6
+            << std::setw(10) << sort / partition
+            << std::setw(12) << std::setprecision(3) << max_diff << std::endl;
+    }
+}
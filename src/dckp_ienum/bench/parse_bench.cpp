@@ -0,0 +1,88 @@
+/*
+Parse throughput benchmark.
+Parses each instance file several times and reports the throughput in MB/s.
+
+Usage: parse_bench [-r repetitions] [-l] input...
+With -l, each input is an instance list (as in dckp_ienum -l).
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dckp_ienum/instance.hpp>
+
+int main(int argc, char* argv[]) {
+    std::size_t repetitions = 5;
+    bool list = false;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repetitions = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "-l") == 0) {
+            list = true;
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if (paths.empty() || repetitions == 0) {
+        std::cerr << "Usage: " << argv[0] << " [-r repetitions] [-l] input..." << std::endl;
+        return 1;
+    }
+
+    if (list) {
+        std::vector<std::filesystem::path> lists;
+        lists.swap(paths);
+
+        for (const auto& list_path : lists) {
+            std::ifstream file(list_path);
+            std::string line;
+            while (std::getline(file, line)) {
+                if (not line.empty()) {
+                    paths.push_back(list_path.parent_path() / line);
+                }
+            }
+        }
+    }
+
+    std::uintmax_t total_bytes = 0;
+    std::chrono::duration<double> total_time(0);
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (const auto& path : paths) {
+        const auto bytes = std::filesystem::file_size(path);
+
+        // Warm up the page cache, so that we measure the parser and not the disk
+        {
+            dckp_ienum::Instance instance;
+            instance.parse(path);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < repetitions; ++r) {
+            dckp_ienum::Instance instance;
+            instance.parse(path);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        total_bytes += bytes * repetitions;
+        total_time += elapsed;
+
+        double mb = static_cast<double>(bytes * repetitions) / 1e6;
+        std::cout << path.c_str() << ": " << mb / elapsed.count() << " MB/s ("
+                  << static_cast<double>(bytes) / 1e6 << " MB, "
+                  << elapsed.count() * 1e3 / static_cast<double>(repetitions) << " ms/parse)\n";
+    }
+
+    std::cout << "total: " << static_cast<double>(total_bytes) / 1e6 / total_time.count() << " MB/s over "
+              << paths.size() << " files" << std::endl;
+}
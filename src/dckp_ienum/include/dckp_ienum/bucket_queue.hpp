@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <dckp_ienum/types.hpp>
+
+namespace dckp_ienum {
+
+/*
+Max-priority queue for small integer keys, as one LIFO list per key: values with the same key come out last in, first out.
+The values stay in a pool of slots for their whole stay (the lists only link slot indices), so push and pop move
+each value once, and both are O(1) but for the scan down to the next non-empty bucket, which is amortised by the pushes.
+
+Keys up to max_key are supported. If that would take more than max_buckets buckets, each bucket covers 2^shift keys,
+and the values of a bucket come out in LIFO order regardless of their exact keys.
+*/
+template <typename T>
+class BucketQueue {
+    using slot_index_t = std::uint32_t;
+    static constexpr slot_index_t none = invalid_v<unsigned int>;
+
+    struct Slot {
+        T value;
+        slot_index_t next;
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<slot_index_t> m_free;
+    std::vector<slot_index_t> m_heads;      // top of the list of each bucket, grown on demand
+    std::size_t m_top = 0;                  // no bucket above it is used
+    std::size_t m_size = 0;
+    std::uint64_t m_max_key;
+    unsigned m_shift = 0;
+
+    std::size_t bucket(std::uint64_t key) const { return std::min(key, m_max_key) >> m_shift; }
+
+    // Move m_top down to the highest used bucket
+    void settle() {
+        while (m_top > 0 && m_heads[m_top] == none) {
+            --m_top;
+        }
+    }
+
+public:
+    explicit BucketQueue(std::uint64_t max_key = 0, std::size_t max_buckets = std::size_t(1) << 20) : m_max_key(max_key) {
+        while ((m_max_key >> m_shift) >= max_buckets) {
+            ++m_shift;
+        }
+    }
+
+    bool empty() const { return m_size == 0; }
+    std::size_t size() const { return m_size; }
+
+    void push(std::uint64_t key, T&& value) {
+        const std::size_t b = bucket(key);
+        if (b >= m_heads.size()) {
+            m_heads.resize(b + 1, none);
+        }
+
+        slot_index_t slot;
+        if (m_free.empty()) {
+            slot = static_cast<slot_index_t>(m_slots.size());
+            m_slots.push_back({ std::move(value), m_heads[b] });
+        } else {
+            slot = m_free.back();
+            m_free.pop_back();
+            m_slots[slot] = { std::move(value), m_heads[b] };
+        }
+
+        m_heads[b] = slot;
+        m_top = m_size == 0? b : std::max(m_top, b);
+        ++m_size;
+    }
+
+    // A value of the highest bucket, the last one pushed there
+    const T& top() const { return m_slots[m_heads[m_top]].value; }
+
+    T pop() {
+        const slot_index_t slot = m_heads[m_top];
+        m_heads[m_top] = m_slots[slot].next;
+        m_free.push_back(slot);
+        --m_size;
+        settle();
+        return std::move(m_slots[slot].value);
+    }
+
+    // Call f(value) for each value of the highest bucket
+    template <typename F>
+    void for_each_top(F&& f) const {
+        if (m_size == 0) {
+            return;
+        }
+        for (slot_index_t slot = m_heads[m_top]; slot != none; slot = m_slots[slot].next) {
+            f(m_slots[slot].value);
+        }
+    }
+
+    // Remove the values for which f(value) is true
+    template <typename F>
+    void remove_if(F&& f) {
+        for (slot_index_t& head : m_heads) {
+            slot_index_t* link = &head;
+            while (*link != none) {
+                const slot_index_t slot = *link;
+                if (f(m_slots[slot].value)) {
+                    *link = m_slots[slot].next;
+                    T removed(std::move(m_slots[slot].value));
+                    m_free.push_back(slot);
+                    --m_size;
+                } else {
+                    link = &m_slots[slot].next;
+                }
+            }
+        }
+        settle();
+    }
+};
+
+} // namespace dckp_ienum
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/types.hpp>
+
+namespace dckp_ienum {
+
+/*
+A set of cliques of the conflict graph covering all of its edges, so that the clique inequalities
+(at most one item per clique) imply all the conflict constraints, with far fewer of them on dense graphs.
+
+Found greedily: each edge not covered yet seeds a clique, grown with the common neighbours of its items.
+The cliques are sorted by their last item and the items of a clique by index, so the cliques involving
+the items from jp1 onwards are a suffix (from first_clique(jp1)).
+*/
+class CliqueCover {
+    std::vector<conflict_index_t> m_offsets;    // clique c is m_items[m_offsets[c] .. m_offsets[c+1])
+    std::vector<item_index_t> m_items;
+    std::vector<conflict_index_t> m_first;      // first clique with its last item >= i
+
+public:
+    CliqueCover() = default;
+    explicit CliqueCover(const Instance& instance);
+
+    conflict_index_t num_cliques() const { return static_cast<conflict_index_t>(m_offsets.size() - 1); }
+
+    // Total number of items over all cliques
+    std::size_t size() const { return m_items.size(); }
+
+    Span<const item_index_t> clique(conflict_index_t c) const {
+        return { m_items.data() + m_offsets[c], m_items.data() + m_offsets[c + 1] };
+    }
+
+    conflict_index_t first_clique(item_index_t i) const { return m_first[i]; }
+};
+
+/*
+A partition of the items into cliques of the conflict graph (possibly of a single item),
+so that a solution takes at most one item from each.
+
+Found greedily: each item not assigned yet, in index order, opens a clique, grown with its later neighbours
+that conflict with all the items already in it. The items of a clique are sorted by index and the cliques
+by their last item, so the cliques with items from jp1 onwards are a suffix (from first_clique(jp1)).
+*/
+class CliquePartition {
+    std::vector<conflict_index_t> m_offsets;    // clique c is m_items[m_offsets[c] .. m_offsets[c+1])
+    std::vector<item_index_t> m_items;
+    std::vector<conflict_index_t> m_first;      // first clique with its last item >= i
+
+public:
+    CliquePartition() = default;
+    explicit CliquePartition(const Instance& instance);
+
+    conflict_index_t num_cliques() const { return static_cast<conflict_index_t>(m_offsets.size() - 1); }
+
+    Span<const item_index_t> clique(conflict_index_t c) const {
+        return { m_items.data() + m_offsets[c], m_items.data() + m_offsets[c + 1] };
+    }
+
+    conflict_index_t first_clique(item_index_t i) const { return m_first[i]; }
+};
+
+} // namespace dckp_ienum
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <dckp_ienum/clique_cover.hpp>
+#include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/types.hpp>
+
+namespace dckp_ienum {
+
+struct CliqueFkpResult {
+    int_profit_t ub;
+    // Of the fixed items and the items taken entirely, at most one per clique (they may still conflict with each other)
+    int_profit_t profit;
+    int_weight_t weight;
+    std::vector<item_index_t> taken;
+
+    void convert(const Instance&, Solution &soln, item_index_t jp1);
+};
+
+// Buffers of solve_clique_fkp, so that it does not allocate once they have grown to the instance
+class CliqueFkpWorkspace {
+public:
+    struct Increment {
+        int_weight_t weight;
+        int_profit_t profit;
+        item_index_t item;
+        item_index_t replaces;  // the item of the previous hull point of the clique, if any
+    };
+
+private:
+    friend void solve_clique_fkp(const Instance&, const CliquePartition&, const Bitset&, item_index_t, int_profit_t, int_weight_t, CliqueFkpWorkspace&, CliqueFkpResult&);
+
+    std::vector<std::uint32_t> m_blocked;       // items conflicting with a fixed item, blocked[i] == m_epoch
+    std::uint32_t m_epoch = 0;
+    std::vector<item_index_t> m_clique;         // candidates of the current clique
+    std::vector<Increment> m_increments;
+};
+
+/*
+Multiple-choice fractional knapsack bound of the items from jp1 on, with the items before jp1 fixed as in
+fixed_items (weighing fixed_w, worth fixed_p).
+The free items are grouped by the cliques of the partition and at most one item is taken from each.
+The items conflicting with a fixed item, or heavier than the residual capacity, are left out.
+The LP of each clique is the upper concave hull of its (weight, profit) points: the increments between
+consecutive hull points are filled greedily by decreasing profit / weight, the last one fractionally.
+It is never looser than the Dantzig bound, and much tighter on dense graphs, in O(n log n).
+*/
+void solve_clique_fkp(const Instance& instance, const CliquePartition& cliques, const Bitset& fixed_items, item_index_t jp1, int_profit_t fixed_p, int_weight_t fixed_w, CliqueFkpWorkspace& workspace, CliqueFkpResult& ans);
+
+} // namespace dckp_ienum
@@ -1,62 +1,61 @@
 #pragma once
 
+#include <algorithm>
+
 #include <dckp_ienum/profiler.hpp>
 #include <dckp_ienum/instance.hpp>
 #include <dckp_ienum/types.hpp>
 
 namespace dckp_ienum {
 
-using ConflictList = std::vector<InstanceConflict>;
-using ConflictConstIterator = ConflictList::const_iterator;
-using ConflictConstReverseIterator = ConflictList::const_reverse_iterator;
+/*
+Check conflicts between an item and the items already in the knapsack,
+given the list of items conflicting with it (see Instance::conflicts and its backward/forward variants).
+*/
+static inline bool check_conflict(const Bitset& items, ConflictList conflicts)
+{
+    profiler::ScopedTicToc tictoc("check_conflict");
 
-static inline ConflictConstIterator find_conflict_iterator(const ConflictList& conflicts, item_index_t item_index) {
-    return std::lower_bound(conflicts.begin(), conflicts.end(), item_index, [](const InstanceConflict& conflict, item_index_t j) {
-        return conflict.i < j;
-    });
+    for (item_index_t j : conflicts) {
+        if (items[j]) {
+            return true;
+        }
+    }
+    return false;
 }
 
-// Advance conflict iterator to the beginning of the conflicts of the item with the specified index.
-static inline void advance_conflict_iterator(item_index_t item_idx, ConflictConstIterator& it, ConflictConstIterator end) {
-    profiler::ScopedTicToc tictoc("advance_rconflict_iterator");
-
-    while (it != end && it->i < item_idx) {
-        ++it;   
+/*
+Check conflicts between item i and the items already in the knapsack.
+On dense instances this is a word-wise AND between the row of i in the conflict matrix and the knapsack,
+otherwise the neighbours of i are tested one at a time.
+*/
+static inline bool check_conflict(const Instance& instance, const Bitset& items, item_index_t i)
+{
+    if (instance.has_conflict_matrix()) {
+        profiler::ScopedTicToc tictoc("check_conflict_matrix");
+        return items.intersects(instance.conflict_row(i));
     }
+    return check_conflict(items, instance.conflicts(i));
 }
-static inline void advance_reverse_conflict_iterator(item_index_t item_idx, ConflictConstReverseIterator& it, ConflictConstReverseIterator end) {
-    profiler::ScopedTicToc tictoc("advance_reverse_rconflict_iterator");
 
-    while (it != end && it->i > item_idx) {
-        ++it;
+// Same as check_conflict, only considering the items j < i
+static inline bool check_backward_conflict(const Instance& instance, const Bitset& items, item_index_t i)
+{
+    if (instance.has_conflict_matrix()) {
+        profiler::ScopedTicToc tictoc("check_conflict_matrix");
+        return items.intersects(instance.conflict_row(i), i);
     }
+    return check_conflict(items, instance.backward_conflicts(i));
 }
 
-/*
-Starting from the rconflict iterator, check conflits between specified item and the items already in the knapsack.
-The iterator is advanced until a conflict is found or when the conflicts of the specified item are exhausted.
-*/ 
-template <typename Iterator>
-static inline bool check_conflict(
-        const std::vector<bool>& items,
-        item_index_t item_idx,
-        Iterator& it,
-        Iterator rconflicts_end)
+// Do items i and j conflict with each other? A bit test on dense instances, a binary search in the (sorted) neighbours of i otherwise.
+static inline bool items_conflict(const Instance& instance, item_index_t i, item_index_t j)
 {
-    static_assert(std::is_same_v<Iterator, ConflictConstReverseIterator> || std::is_same_v<Iterator, ConflictConstIterator>);
-
-    profiler::ScopedTicToc tictoc("check_conflict");
-
-    for (; it != rconflicts_end; ++it) {
-        if (it->i != item_idx) {
-            break;
-        }
-
-        if (items[it->j]) {
-            return true;
-        }
+    if (instance.has_conflict_matrix()) {
+        return (instance.conflict_row(i)[j / Bitset::WORD_BITS] >> (j % Bitset::WORD_BITS)) & 1;
     }
-    return false;
+    const ConflictList conflicts = instance.conflicts(i);
+    return std::binary_search(conflicts.begin(), conflicts.end(), j);
 }
 
-} // namespace dckp_ienum
\ No newline at end of file
+} // namespace dckp_ienum
@@ -1,10 +1,58 @@
 #pragma once
 
+#include <ostream>
+
 #include <dckp_ienum/types.hpp>
 #include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/upper_bound.hpp>
 
 namespace dckp_ienum {
 
-void solve_dckp_bnb(const dckp_ienum::Instance& instance, Solution& soln, bool use_ldckp, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback);
+struct BnbParams {
+    /*
+    Bytes the open nodes may take (not counting the spare capacity of the heap), 0 = unlimited.
+    Past it, the nodes that cannot beat the incumbent are dropped, then the subtree of the best open node is explored
+    depth-first (so the open nodes grow by O(depth) at most) until the search is back within the budget.
+    The bound stays valid, as no node that can beat the incumbent is dropped.
+    */
+    std::size_t memory_budget = 0;
+
+    // Fix out, when branching, the items that conflict with the ones taken or do not fit anymore, skipping their levels
+    bool propagate = true;
+};
+
+void solve_dckp_bnb(const dckp_ienum::Instance& instance, Solution& soln, UpperBound bound, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const BnbParams& params = {});
+
+struct BnbMtParams {
+    // 0 = one per hardware thread
+    unsigned num_threads = 0;
+
+    // The memory budget is split between the threads
+    BnbParams bnb;
+};
+
+struct BnbMtStats {
+    std::size_t nodes = 0;      // expanded
+    std::size_t handovers = 0;  // nodes handed over to another thread
+
+    BnbMtStats& operator+=(const BnbMtStats& other) {
+        nodes += other.nodes;
+        handovers += other.handovers;
+        return *this;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const BnbMtStats& stats) {
+        return os << "nodes: " << stats.nodes << ", " << "handovers: " << stats.handovers;
+    }
+};
+
+/*
+Best-first B&B on several threads, each with its own heap of open nodes, sharing the best solution found (see SharedIncumbent).
+A thread that runs out of nodes waits for one, and the busy threads hand over their best open node (the most promising
+subtree) while someone is waiting. The search ends when all the threads wait at once.
+If stopped early, the bound is the best one over the open nodes of all the threads and the ones being handed over.
+The solution callback is only invoked from the calling thread.
+*/
+BnbMtStats solve_dckp_bnb_mt(const dckp_ienum::Instance& instance, Solution& soln, UpperBound bound, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const BnbMtParams& params = {});
 
-} // namespace dckp_ienum
\ No newline at end of file
+} // namespace dckp_ienum
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include <dckp_ienum/instance.hpp>
+
+namespace dckp_ienum {
+
+enum class GreedyScore {
+    Ratio,              // p / w (the order set by Instance::sort_items)
+    DegreeRatio,        // p / (w * (1 + deg))
+    NeighbourWeight,    // p / (w + lambda * sum of the weights of the neighbours)
+};
+
+struct GreedyRule {
+    GreedyScore score;
+    float_t lambda = 0;
+};
+
+struct GreedyPortfolioParams {
+    std::vector<GreedyRule> rules {
+        { GreedyScore::Ratio },
+        { GreedyScore::DegreeRatio },
+        { GreedyScore::NeighbourWeight, 0.1 },
+        { GreedyScore::NeighbourWeight, 1.0 },
+    };
+
+    // 0 = one per hardware thread (never more than the rules)
+    unsigned num_threads = 0;
+};
+
+/*
+Run one greedy pass per scoring rule, concurrently, and keep the best solution.
+The solution callback is only invoked from the calling thread.
+*/
+void solve_dckp_greedy_portfolio(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const GreedyPortfolioParams& params = {});
+
+} // namespace dckp_ienum
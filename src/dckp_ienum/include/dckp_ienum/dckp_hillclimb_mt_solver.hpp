@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include <dckp_ienum/dckp_hillclimb_solver.hpp>
+#include <dckp_ienum/instance.hpp>
+
+namespace dckp_ienum {
+
+struct HillclimbMtParams {
+    // 0 = one per hardware thread
+    unsigned num_threads = 0;
+
+    // Probability to restart from the shared incumbent (perturbed) instead of a randomised greedy solution
+    float_t incumbent_restart_probability = 0.5;
+
+    // Fraction of the incumbent items dropped when restarting from it
+    float_t perturbation_strength = 0.2;
+
+    // If hillclimb.compound_moves is set, only the local optima of the simple moves worth at least this fraction
+    // of the incumbent go on with the compound moves, which cost more than the rest of a start
+    float_t compound_threshold = 0.99;
+
+    std::uint64_t seed = 42;
+
+    HillclimbParams hillclimb;
+};
+
+/*
+Multi-start hillclimb on several threads sharing the best solution found (see SharedIncumbent).
+Each worker repeatedly builds a starting solution, climbs to a local optimum and publishes it, until the stop token is set.
+The first start of the first worker is the plain greedy solution.
+The solution callback is only invoked from the calling thread.
+*/
+HillclimbStats solve_dckp_hillclimb_mt(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const HillclimbMtParams& params = {});
+
+} // namespace dckp_ienum
@@ -7,12 +7,37 @@ namespace dckp_ienum {
 struct HillclimbStats {
     std::size_t swaps = 0;
     std::size_t adds = 0;
+    std::size_t drops = 0;
+    std::size_t exchanges = 0;
+
+    HillclimbStats& operator+=(const HillclimbStats& other) {
+        swaps += other.swaps;
+        adds += other.adds;
+        drops += other.drops;
+        exchanges += other.exchanges;
+        return *this;
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const HillclimbStats& stats) {
-        return os << "swaps: " << stats.swaps << ", " << "adds: " << stats.adds;
+        return os << "swaps: " << stats.swaps << ", " << "adds: " << stats.adds << ", " << "drops: " << stats.drops << ", " << "exchanges: " << stats.exchanges;
     }
 };
 
-HillclimbStats solve_dckp_hillclimb(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback);
+enum class HillclimbNeighbourhood {
+    Full,           // enumerate every move at each iteration
+    Incremental,    // only re-evaluate the items touched by the last move
+};
+
+struct HillclimbParams {
+    HillclimbNeighbourhood neighbourhood = HillclimbNeighbourhood::Incremental;
+
+    // At local optima of the add and swap moves, try the drop-1-add-2, drop-2-add-1 and ejection chain moves
+    bool compound_moves = true;
+};
+
+// Hillclimb from a feasible solution, up to a local optimum
+HillclimbStats solution_hillclimb_improve(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const HillclimbParams& params = {});
+
+HillclimbStats solve_dckp_hillclimb(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const HillclimbParams& params = {});
 
 } // namespace dckp_ienum
\ No newline at end of file
@@ -2,9 +2,11 @@
 
 #include "dckp_ienum/types.hpp"
 #include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/upper_bound.hpp>
 
 namespace dckp_ienum {
 
-void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback);
+// bound is Fkp or CliqueFkp
+void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, UpperBound bound, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback);
 
 } // namespace dckp_ienum
\ No newline at end of file
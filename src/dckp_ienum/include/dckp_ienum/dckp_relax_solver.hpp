@@ -1,9 +1,10 @@
 #include <dckp_ienum/conflicts.hpp>
 #include <dckp_ienum/instance.hpp>
 #include <dckp_ienum/types.hpp>
+#include <dckp_ienum/upper_bound.hpp>
 
 namespace dckp_ienum {
 
-void solve_dckp_relax(const Instance& instance, Solution& solution, bool use_ldckp, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback);
+void solve_dckp_relax(const Instance& instance, Solution& solution, UpperBound bound, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback);
 
 } // namespace dckp_ienum
\ No newline at end of file
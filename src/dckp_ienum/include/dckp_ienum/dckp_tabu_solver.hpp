@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+#include <dckp_ienum/dckp_hillclimb_solver.hpp>
+#include <dckp_ienum/instance.hpp>
+
+namespace dckp_ienum {
+
+struct TabuParams {
+    // A moved item cannot be moved again for min_tenure + [0, tenure_range) iterations, unless that improves the best solution
+    std::size_t min_tenure = 7;
+    std::size_t tenure_range = 10;
+
+    // Iterations without improving the best solution before a perturbation
+    std::size_t max_stall = 2000;
+
+    // Fraction of the selected items dropped by a perturbation
+    float_t perturbation_strength = 0.2;
+
+    // Every restart_every-th perturbation starts from the best solution instead of the current one
+    std::size_t restart_every = 5;
+
+    std::uint64_t seed = 42;
+};
+
+/*
+Tabu search over the add, swap and drop moves, with perturbations when it stalls (iterated local search).
+Starts from the greedy solution and only returns when the stop token is set.
+*/
+HillclimbStats solve_dckp_tabu(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const TabuParams& params = {});
+
+} // namespace dckp_ienum
@@ -14,6 +14,11 @@ struct FkpResult {
     void convert(const Instance&, Solution &soln, item_index_t jp1);
 };
 
-FkpResult solve_fkp_fast(const Instance& instance, item_index_t jp1, int_profit_t fixed_p, int_weight_t fixed_w);
+/*
+Dantzig bound of the items from jp1 on, with the items before jp1 fixed (weighing fixed_w, worth fixed_p).
+The critical item is found by binary search over the prefix sums of the instance, in O(log n),
+or by galloping from hint (e.g. the fractional_idx of a parent node) when given.
+*/
+FkpResult solve_fkp_fast(const Instance& instance, item_index_t jp1, int_profit_t fixed_p, int_weight_t fixed_w, item_index_t hint = invalid_v<item_index_t>);
 
 } // namespace dckp_ienum
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <vector>
 #include <filesystem>
+#include <memory>
 #include <Eigen/Dense>
 
 #include <dckp_ienum/types.hpp>
@@ -16,57 +17,145 @@ struct InstanceConflict {
     friend std::ostream& operator<<(std::ostream& os, const InstanceConflict& conflict) {
         return os << conflict.i << "->" << conflict.j;
     }
-
-    struct IndexLt {
-        bool operator()(const InstanceConflict& a, const InstanceConflict& b) const {
-            if (a.i == b.i) {
-                return a.j < b.j;
-            } else {
-                return a.i < b.i;
-            }
-        }
-    };
 };
 
+// Items conflicting with a given item, in storage order
+using ConflictList = Span<const item_index_t>;
+
 struct BadInstanceException : public std::runtime_error {
     BadInstanceException(const std::string& msg) : std::runtime_error(msg) {}
 };
 
+// Owning storage of an instance built in memory, either parsed or derived from another instance.
+struct InstanceData {
+    std::vector<item_index_t> o2s_indices; // original-to-storage map
+    std::vector<item_index_t> s2o_indices; // storage-to-original map
+
+    std::vector<int_weight_t> weights;
+    std::vector<int_profit_t> profits;
+
+    // weight_prefix[i] (profit_prefix[i]) is the total weight (profit) of the items before i, so both have num_items+1 entries
+    std::vector<weight_sum_t> weight_prefix;
+    std::vector<profit_sum_t> profit_prefix;
+
+    // Conflict graph in compressed sparse row format.
+    // The neighbours of item i are adjacency[adjacency_offsets[i] .. adjacency_offsets[i+1]), sorted,
+    // and adjacency_splits[i] is the position of the first one greater than i.
+    std::vector<conflict_index_t> adjacency_offsets;
+    std::vector<conflict_index_t> adjacency_splits;
+    std::vector<item_index_t> adjacency;
+
+    // Conflict graph as a dense bit matrix, one row of Bitset::num_words(num_items) words per item.
+    // Only built for graphs at least CONFLICT_MATRIX_MIN_DENSITY dense, empty otherwise.
+    std::vector<Bitset::word_t> conflict_matrix;
+
+    // Below this density, walking the neighbour list of an item is cheaper than scanning its whole row
+    static constexpr float_t CONFLICT_MATRIX_MIN_DENSITY = 0.01;
+    static constexpr std::size_t CONFLICT_MATRIX_MAX_BYTES = std::size_t(1) << 28;
+
+    // Build the adjacency of num_items items from an edge list. Each edge is stored in both directions,
+    // and once however many times it is listed.
+    void build_adjacency(item_index_t num_items, const std::vector<InstanceConflict>& edges);
+
+    // Build the conflict matrix from the adjacency, if the graph is dense enough
+    void build_conflict_matrix(item_index_t num_items);
+
+    // Build the prefix sums of the weights and profits
+    void build_prefix_sums();
+};
+
+/*
+The instance data is immutable once built: the arrays below are views over memory kept alive by m_storage,
+which is either an InstanceData or a memory-mapped cache file (see instance_cache.hpp).
+Copies of an instance are therefore cheap, and share the same storage.
+*/
 class Instance {
-    Eigen::ArrayX<item_index_t> m_o2s_indices; // original-to-storage map
-    Eigen::ArrayX<item_index_t> m_s2o_indices; // storage-to-original map
+    std::shared_ptr<const void> m_storage;
+
+    Span<const item_index_t> m_o2s_indices; // original-to-storage map
+    Span<const item_index_t> m_s2o_indices; // storage-to-original map
+
+    Span<const int_weight_t> m_weights;
+    Span<const int_profit_t> m_profits;
 
-    Eigen::ArrayX<int_weight_t> m_weights;
-    Eigen::ArrayX<int_profit_t> m_profits;
+    Span<const weight_sum_t> m_weight_prefix;
+    Span<const profit_sum_t> m_profit_prefix;
 
-    int_weight_t m_capacity;
-    item_index_t m_num_items;
+    int_weight_t m_capacity = 0;
+    item_index_t m_num_items = 0;
     
-    std::vector<InstanceConflict> m_conflicts;
-    std::vector<InstanceConflict> m_rconflicts;
+    Span<const conflict_index_t> m_adjacency_offsets;
+    Span<const conflict_index_t> m_adjacency_splits;
+    Span<const item_index_t> m_adjacency;
+
+    Span<const Bitset::word_t> m_conflict_matrix;
+
+    template <typename T>
+    using ArrayMap = Eigen::Map<const Eigen::ArrayX<T>>;
+
+    // Build the structures derived from the adjacency, then freeze the data
+    void set_data(std::shared_ptr<InstanceData> data, item_index_t num_items, int_weight_t capacity);
+
+    friend class InstanceCache;
 
 public:
     item_index_t num_items() const { return m_num_items; }
     int_weight_t capacity() const { return m_capacity; }
     
-    auto& conflicts() const { return m_conflicts; }
-    auto& rconflicts() const { return m_rconflicts; }
+    // Each conflict counts once, even though the adjacency stores it for both of its items
+    conflict_index_t num_conflicts() const { return static_cast<conflict_index_t>(m_adjacency.size() / 2); }
 
-    auto weights() const { return m_weights.topRows(num_items()); }
-    auto weight(Eigen::Index i) const { return weights()(i); }
+    // All the items conflicting with item i
+    ConflictList conflicts(item_index_t i) const {
+        return { m_adjacency.data() + m_adjacency_offsets[i], m_adjacency.data() + m_adjacency_offsets[i + 1] };
+    }
+    // Items j < i conflicting with item i
+    ConflictList backward_conflicts(item_index_t i) const {
+        return { m_adjacency.data() + m_adjacency_offsets[i], m_adjacency.data() + m_adjacency_splits[i] };
+    }
+    // Items j > i conflicting with item i
+    ConflictList forward_conflicts(item_index_t i) const {
+        return { m_adjacency.data() + m_adjacency_splits[i], m_adjacency.data() + m_adjacency_offsets[i + 1] };
+    }
+
+    // Dense conflict matrix, see InstanceData::conflict_matrix
+    bool has_conflict_matrix() const { return not m_conflict_matrix.empty(); }
+    // Bit j of the row of item i is set iff i and j conflict
+    const Bitset::word_t* conflict_row(item_index_t i) const {
+        return m_conflict_matrix.data() + i * Bitset::num_words(num_items());
+    }
+
+    auto weights() const { return ArrayMap<int_weight_t>(m_weights.data(), num_items()); }
+    auto weight(Eigen::Index i) const { return m_weights[i]; }
     
-    auto profits() const { return m_profits.topRows(num_items()); }
-    auto profit(Eigen::Index i) const { return profits()(i); }
+    auto profits() const { return ArrayMap<int_profit_t>(m_profits.data(), num_items()); }
+    auto profit(Eigen::Index i) const { return m_profits[i]; }
 
-    auto s2o_index_map() const { return m_s2o_indices.topRows(num_items()); }
-    auto o2s_index_map() const { return m_o2s_indices.topRows(num_items()); }
-    auto s2o_index(item_index_t i) const { return s2o_index_map()(i); }
-    auto o2s_index(item_index_t i) const { return o2s_index_map()(i); }
+    // Total weight (profit) of the items in [begin, end)
+    weight_sum_t weight_sum(item_index_t begin, item_index_t end) const { return m_weight_prefix[end] - m_weight_prefix[begin]; }
+    profit_sum_t profit_sum(item_index_t begin, item_index_t end) const { return m_profit_prefix[end] - m_profit_prefix[begin]; }
+
+    // Prefix sums of the weights (profits): entry i is the total weight (profit) of the items before i
+    Span<const weight_sum_t> weight_prefix() const { return m_weight_prefix; }
+    Span<const profit_sum_t> profit_prefix() const { return m_profit_prefix; }
+
+    auto s2o_index_map() const { return ArrayMap<item_index_t>(m_s2o_indices.data(), num_items()); }
+    // Indexed by original item, so a subinstance maps more items than it has
+    auto o2s_index_map() const { return ArrayMap<item_index_t>(m_o2s_indices.data(), m_o2s_indices.size()); }
+    auto s2o_index(item_index_t i) const { return m_s2o_indices[i]; }
+    auto o2s_index(item_index_t i) const { return m_o2s_indices[i]; }
     
     void parse(const std::filesystem::path& path);
 
     void clear();
     void sort_items();
+
+    /*
+    Instance of the given items only (in increasing storage order, so that the p/w order is kept) and the given capacity.
+    The conflicts with the other items are dropped. Its s2o_index maps to the original indices of this instance,
+    and the items left out have no storage index (o2s_index is invalid_v).
+    */
+    Instance subinstance(const std::vector<item_index_t>& items, int_weight_t capacity) const;
 };
 
 } // namespace dckp_ienum
\ No newline at end of file
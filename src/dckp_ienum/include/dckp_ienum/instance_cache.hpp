@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include <dckp_ienum/instance.hpp>
+
+namespace dckp_ienum {
+
+/*
+Cache of sorted instances in a versioned binary format, keyed by the content hash of the source file.
+
+A cache file holds a header followed by the arrays of the instance, each aligned to a cache line,
+so that it can be memory-mapped and used in place without any copy or parsing.
+Bump FORMAT_VERSION whenever the layout or the meaning of the stored data changes (e.g. the item order).
+*/
+class InstanceCache {
+    std::filesystem::path m_dir;
+
+public:
+    static constexpr std::uint32_t FORMAT_VERSION = 5;
+
+    explicit InstanceCache(std::filesystem::path dir);
+
+    // Load the sorted instance of the source file. On a cache miss, the source is parsed, sorted and stored.
+    Instance load(const std::filesystem::path& source) const;
+
+    static std::uint64_t hash(std::string_view data);
+
+    static void write(const std::filesystem::path& path, const Instance& instance, std::uint64_t source_hash, std::uint64_t source_size);
+
+    // Returns false when the file is missing, stale or malformed
+    static bool read(const std::filesystem::path& path, std::uint64_t source_hash, std::uint64_t source_size, Instance& instance);
+};
+
+} // namespace dckp_ienum
@@ -2,24 +2,118 @@
 
 #include <Eigen/Dense>
 
+#include <dckp_ienum/clique_cover.hpp>
 #include <dckp_ienum/conflicts.hpp>
 #include <dckp_ienum/instance.hpp>
 #include <dckp_ienum/types.hpp>
 #include <limits>
+#include <vector>
 
 namespace dckp_ienum {
 
+// How the fractional knapsack of each subgradient iteration is solved
+enum class LdckpFkpAlgorithm {
+    Sort,       // sort the items by ratio, O(n log n)
+    Partition,  // partition around pivot ratios (Balas-Zemel), O(n) on average
+};
+
+// Length of the subgradient steps
+enum class LdckpStepPolicy {
+    Constant,   // alpha along the normalized subgradient
+    Polyak,     // theta (Lk - lower_bound) / |g|^2, with theta halved whenever the bound stalls
+};
+
 struct LdckpSolverParams {
     float_t alpha = 2.0;
     std::size_t k_max = 500;
+    LdckpFkpAlgorithm fkp = LdckpFkpAlgorithm::Partition;
+
+    LdckpStepPolicy step = LdckpStepPolicy::Polyak;
+    float_t theta = 2.0;
+    std::size_t stall_iterations = 10;  // halve theta after this many iterations without a better bound
+    float_t min_theta = 1e-3;           // and stop once it is this small
+
+    // Profit of the incumbent: the target of Polyak steps (the constant step is used instead without one),
+    // and the solver stops as soon as the bound shows that the subproblem cannot beat it
+    int_profit_t lower_bound = 0;
+
+    // Budget and step when starting from the multipliers of the parent node, which are already close
+    std::size_t warm_k_max = 100;
+    float_t warm_alpha = 1.0;
+    float_t warm_theta = 1.0;
+
+    // If given, dualise the clique inequalities of this cover (of the same instance) instead of the conflicts:
+    // far fewer multipliers on dense graphs, and a bound at least as tight
+    const CliqueCover* cliques = nullptr;
+};
+
+/*
+A non-zero Lagrange multiplier, by index of the dualised constraint.
+Conflicts are numbered in the order of the backward conflicts of the items and cliques as in CliqueCover,
+so those of the subproblem from jp1 onwards are a suffix. float is enough precision for a starting point.
+*/
+struct LdckpMultiplier {
+    conflict_index_t constraint;
+    float lambda;
 };
 
+// Sorted by conflict
+using LdckpMultipliers = std::vector<LdckpMultiplier>;
+
+// The subgradient steps may approach an integer optimum from just below, so bounds within this much of an integer round up to it
+static constexpr float_t LDCKP_UB_TOLERANCE = 1e-6;
+
 struct LdckpResult {
+    // Indexed by item, only the items from jp1 onwards are meaningful
     Eigen::VectorX<float_t> x;
     float_t ub = std::numeric_limits<float_t>::max();
-    void convert(const Instance& instance, Solution &soln, item_index_t j);
+    // The multipliers that gave ub
+    LdckpMultipliers multipliers;
+    // Subgradient iterations done
+    std::size_t iterations = 0;
+
+    // ub as a bound on the integer profit, see LDCKP_UB_TOLERANCE
+    int_profit_t int_ub() const;
+
+    void convert(const Instance& instance, Solution &soln, item_index_t jp1);
+};
+
+/*
+Buffers of solve_ldckp, sized for the whole instance so that they fit any subproblem.
+Once reserved, solving with the same workspace and result does no heap allocation.
+A workspace must not be shared between threads.
+*/
+class LdckpWorkspace {
+public:
+    LdckpWorkspace() = default;
+    explicit LdckpWorkspace(const Instance& instance) { reserve(instance); }
+
+    // Size the buffers for the instance and, if given, its clique cover (a no-op if they already are)
+    void reserve(const Instance& instance, const CliqueCover* cliques = nullptr);
+
+private:
+    friend void solve_ldckp(const Instance&, const Bitset&, item_index_t, int_profit_t, int_weight_t, const LdckpSolverParams&, LdckpWorkspace&, LdckpResult&, const LdckpMultipliers*);
+
+    Eigen::VectorX<float_t> m_x;            // by item
+    Eigen::VectorX<float_t> m_ps;           // modified profits, from jp1
+    Eigen::VectorX<float_t> m_ratios;       // modified profit / weight, from jp1
+    Eigen::ArrayX<item_index_t> m_indices;  // from jp1
+    Eigen::VectorX<float_t> m_lambdak;      // by constraint
+    Eigen::VectorX<float_t> m_dlambdak;     // by constraint
+    Eigen::VectorX<float_t> m_best_lambdak; // by constraint
+    Eigen::VectorX<float_t> m_rhs;          // by constraint
+    std::vector<conflict_index_t> m_member_offsets; // free items of constraint c are m_members[m_member_offsets[c] .. m_member_offsets[c+1])
+    std::vector<item_index_t> m_members;            // from jp1
 };
 
-LdckpResult solve_ldckp(const Instance& instance, std::vector<bool> fixed_items, item_index_t jp1, int_profit_t fixed_items_p, int_weight_t fixed_items_w, ConflictConstIterator jth_rconflict_iterator, const LdckpSolverParams& params);
+/*
+Solve the Lagrangian relaxation of the subproblem with the items before jp1 fixed, reusing the given buffers.
+If warm_start is given (e.g. the multipliers of the parent subproblem), start from it rather than from zero,
+with the warm budget and step of params. Any multipliers give a valid bound.
+*/
+void solve_ldckp(const Instance& instance, const Bitset& fixed_items, item_index_t jp1, int_profit_t fixed_items_p, int_weight_t fixed_items_w, const LdckpSolverParams& params, LdckpWorkspace& workspace, LdckpResult& ans, const LdckpMultipliers* warm_start = nullptr);
+
+// As above, with a workspace local to the calling thread
+LdckpResult solve_ldckp(const Instance& instance, const Bitset& fixed_items, item_index_t jp1, int_profit_t fixed_items_p, int_weight_t fixed_items_w, const LdckpSolverParams& params);
 
 } // namespace dckp_ienum
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <stdexcept>
+
+#include <dckp_ienum/dckp_hillclimb_solver.hpp>
+#include <dckp_ienum/solution_state.hpp>
+#include <dckp_ienum/types.hpp>
+
+namespace dckp_ienum {
+
+/*
+Moves of the local search solvers. They do not check feasibility: the caller must only apply feasible moves.
+*/
+
+class AddMove {
+    item_index_t i;
+
+public:
+    AddMove(item_index_t i) : i(i) {}
+
+    void apply(SolutionState& state, HillclimbStats& stats) const {
+        state.add(i);
+
+        ++stats.adds;
+    }
+
+    // Call f on each item entering or leaving the knapsack
+    template <typename F>
+    void for_each_item(F&& f) const { f(i); }
+};
+
+class SwapMove {
+    item_index_t i;
+    item_index_t j;
+
+public:
+    // Take i out of the knapsack, put j in
+    SwapMove(item_index_t i, item_index_t j) : i(i), j(j) {}
+
+    void apply(SolutionState& state, HillclimbStats& stats) const {
+        state.remove(i);
+        state.add(j);
+
+        ++stats.swaps;
+    }
+
+    template <typename F>
+    void for_each_item(F&& f) const { f(i); f(j); }
+};
+
+class DropMove {
+    item_index_t i;
+
+public:
+    DropMove(item_index_t i) : i(i) {}
+
+    void apply(SolutionState& state, HillclimbStats& stats) const {
+        state.remove(i);
+
+        ++stats.drops;
+    }
+
+    template <typename F>
+    void for_each_item(F&& f) const { f(i); }
+};
+
+/*
+Exchange of Out items of the knapsack for In items out of it.
+ExchangeMove<2, 2> is the ejection chain j -> i -> k -> l: j enters ejecting its only blocker i,
+which frees k, which enters ejecting its other blocker l.
+*/
+template <std::size_t Out, std::size_t In>
+class ExchangeMove {
+    std::array<item_index_t, Out> out;
+    std::array<item_index_t, In> in;
+
+public:
+    ExchangeMove(std::array<item_index_t, Out> out, std::array<item_index_t, In> in) : out(out), in(in) {
+        #ifdef ENABLE_CHECKS
+        for_each_item([&](item_index_t i) {
+            std::size_t count = 0;
+            for_each_item([&](item_index_t j) { count += i == j; });
+            if (count != 1) {
+                throw std::runtime_error("ExchangeMove items are not distinct");
+            }
+        });
+        #endif // ENABLE_CHECKS
+    }
+
+    void apply(SolutionState& state, HillclimbStats& stats) const {
+        for (item_index_t i : out) {
+            state.remove(i);
+        }
+        for (item_index_t j : in) {
+            state.add(j);
+        }
+
+        ++stats.exchanges;
+    }
+
+    template <typename F>
+    void for_each_item(F&& f) const {
+        for (item_index_t i : out) {
+            f(i);
+        }
+        for (item_index_t j : in) {
+            f(j);
+        }
+    }
+};
+
+using Drop1Add2Move = ExchangeMove<1, 2>;
+using Drop2Add1Move = ExchangeMove<2, 1>;
+using EjectionChainMove = ExchangeMove<2, 2>;
+
+} // namespace dckp_ienum
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace dckp_ienum {
+
+// Read-only, private memory mapping of a whole file.
+class MappedFile {
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    // Hint for the kernel on how the mapping is going to be read
+    enum class Access {
+        Sequential,
+        Random
+    };
+
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path, Access access = Access::Sequential);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    std::string_view view() const { return { m_data, m_size }; }
+};
+
+} // namespace dckp_ienum
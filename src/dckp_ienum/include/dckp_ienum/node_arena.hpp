@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <dckp_ienum/types.hpp>
+
+namespace dckp_ienum {
+
+using node_index_t = unsigned int;
+
+/*
+Paths of the search tree of B&B, as one record per item taken: the item and the record of the previous item taken.
+A node is a record and a depth (the items before it are fixed, and only the ones in its chain are taken), so a
+node that drops an item shares the record of its parent. This costs 12 bytes per item taken instead of a copy of
+the prefix per node, and a path is only rebuilt, into a reused bitset, when its node is expanded.
+
+The records are reference counted, by the nodes that end on them and by the records that follow them.
+Releasing the last reference frees the record, and then its predecessor's reference, so that only the paths of
+the open nodes are kept.
+*/
+class NodeArena {
+    struct Record {
+        node_index_t previous;
+        item_index_t item;
+        std::uint32_t refs;
+    };
+
+    std::vector<Record> m_records;
+    std::vector<node_index_t> m_free;
+
+public:
+    // The path that takes no item, which is not stored
+    static constexpr node_index_t empty = invalid_v<node_index_t>;
+
+    // Path of previous followed by item, referenced once by the returned handle
+    node_index_t push(node_index_t previous, item_index_t item);
+
+    // Path taking the items set in x, referenced once by the returned handle
+    node_index_t push(const Bitset& x);
+
+    // Another reference to path
+    node_index_t acquire(node_index_t path) {
+        if (path != empty) {
+            ++m_records[path].refs;
+        }
+        return path;
+    }
+
+    // Drop a reference to path, freeing it (and possibly the records before it) if it was the last one
+    void release(node_index_t path);
+
+    // Keep the size of x, set the items of path and clear the others
+    void path(node_index_t path, Bitset& x) const;
+
+    // Number of live records
+    std::size_t size() const { return m_records.size() - m_free.size(); }
+
+    // Bytes of the live records
+    std::size_t memory_usage() const { return size() * sizeof(Record); }
+};
+
+} // namespace dckp_ienum
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/types.hpp>
+
+namespace dckp_ienum {
+
+struct ProbingParams {
+    // 0 = one per hardware thread
+    unsigned num_threads = 0;
+
+    // Fixing items tightens the bounds of the others, so the items left free are probed again, up to this many times
+    unsigned max_rounds = 8;
+};
+
+struct ProbingResult {
+    // The free items, with the capacity left by the items fixed in
+    Instance reduced;
+
+    // Items of the instance that every solution better than the incumbent takes
+    Bitset fixed_in;
+    int_profit_t fixed_p = 0;
+    int_weight_t fixed_w = 0;
+    item_index_t num_fixed_out = 0;
+
+    // No solution is better than the incumbent (reduced is then empty)
+    bool closed = false;
+
+    // Solution of the instance made of the items fixed in and reduced_soln, a solution of the reduced instance
+    void expand(const Instance& instance, const Solution& reduced_soln, Solution& soln) const;
+};
+
+/*
+Probe each item of the instance against the incumbent, concurrently: if the Dantzig bound with the item taken
+(its neighbours left out, its weight off the capacity) is no better than the incumbent, the item is fixed out,
+and if the bound without it is no better, it is fixed in. Taking an item fixes its neighbours out.
+Every fixing only holds for the solutions better than the incumbent, so the best solution of the instance is
+either the incumbent or expand() of the best solution of the reduced instance.
+*/
+ProbingResult probe_items(const Instance& instance, const Solution& incumbent, const ProbingParams& params = {});
+
+} // namespace dckp_ienum
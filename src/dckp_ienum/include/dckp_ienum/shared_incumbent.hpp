@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <dckp_ienum/types.hpp>
+
+namespace dckp_ienum {
+
+/*
+Best solution shared by concurrent solvers.
+
+The profit is an atomic that can be read at any time to prune against. The solution itself is protected by a seqlock:
+a writer makes the sequence odd, stores the words and makes it even again, while readers copy the words and retry
+if the sequence was odd or changed in the meantime. Readers never block writers, and writers only wait for each other
+for the duration of a copy.
+*/
+class SharedIncumbent {
+    using word_t = Bitset::word_t;
+
+    std::size_t m_size;
+    std::size_t m_num_words;
+    std::unique_ptr<std::atomic<word_t>[]> m_words;
+    std::atomic<int_weight_t> m_weight = 0;
+    std::atomic<int_profit_t> m_profit = 0;
+    std::atomic<std::uint64_t> m_sequence = 0;
+
+public:
+    explicit SharedIncumbent(std::size_t num_items);
+
+    int_profit_t profit() const { return m_profit.load(std::memory_order_acquire); }
+
+    // Store soln if it beats the incumbent. Returns whether it did.
+    bool publish(const Solution& soln);
+
+    // Copy the incumbent into soln (x, p and w)
+    void read(Solution& soln) const;
+};
+
+} // namespace dckp_ienum
@@ -4,7 +4,7 @@
 
 namespace dckp_ienum {
 
-void solution_greedy_improve(const Instance& instance, Solution& soln, item_index_t jp1, ConflictConstIterator& jp1th_rconflicts_iterator, ConflictConstIterator jp1th_conflicts_begin);
-void solution_greedy_remove_conflicts(const Instance& instance, Solution& soln, item_index_t jp1, ConflictConstIterator jth_rconflicts_begin);
+void solution_greedy_improve(const Instance& instance, Solution& soln, item_index_t jp1);
+void solution_greedy_remove_conflicts(const Instance& instance, Solution& soln, item_index_t jp1);
 
-} // namespace dckp_ienum
\ No newline at end of file
+} // namespace dckp_ienum
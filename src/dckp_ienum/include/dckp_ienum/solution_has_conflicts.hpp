@@ -2,19 +2,19 @@
 
 #include <Eigen/Dense>
 
+#include <dckp_ienum/conflicts.hpp>
 #include <dckp_ienum/instance.hpp>
 #include <dckp_ienum/types.hpp>
 #include <dckp_ienum/profiler.hpp>
 
 namespace dckp_ienum {
 
-template <typename BoolVector>
-bool solution_has_conflicts(const dckp_ienum::Instance& instance, const BoolVector& x) {
+inline bool solution_has_conflicts(const dckp_ienum::Instance& instance, const Bitset& x) {
     profiler::ScopedTicToc tictoc("solution_has_conflicts");
 
-    for (conflict_index_t i = 0; i < instance.conflicts().size(); ++i) {
-        const InstanceConflict& conflict = instance.conflicts().at(i);
-        if (x[conflict.i] && x[conflict.j]) {
+    // Each conflict is found from its greater item
+    for (std::size_t i = x.find_next(0); i < x.size(); i = x.find_next(i + 1)) {
+        if (check_backward_conflict(instance, x, i)) {
             return true;
         }
     }
@@ -22,4 +22,4 @@ bool solution_has_conflicts(const dckp_ienum::Instance& instance, const BoolVect
     return false;
 }
 
-} // namespace dckp_ienum
\ No newline at end of file
+} // namespace dckp_ienum
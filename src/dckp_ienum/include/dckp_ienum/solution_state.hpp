@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/types.hpp>
+
+namespace dckp_ienum {
+
+/*
+Tracks, alongside a solution, how many of the selected items each item conflicts with.
+Adding or removing an item updates the counters of its neighbours, so checking whether an item
+conflicts with the knapsack is O(1), and the cost of keeping the counters is O(degree) per change.
+
+The solution is owned by the caller: it must only be modified through add and remove while tracked.
+*/
+class SolutionState {
+    const Instance* m_instance;
+    Solution* m_soln;
+    std::vector<item_index_t> m_blocked;
+    std::vector<item_index_t> m_blockers;   // XOR of the selected neighbours of each item
+
+public:
+    // Start tracking soln, computing the counters from its current items
+    SolutionState(const Instance& instance, Solution& soln);
+
+    const Instance& instance() const { return *m_instance; }
+    const Solution& solution() const { return *m_soln; }
+
+    // Recompute the counters after the solution was changed from outside
+    void sync();
+
+    // Remove all the items
+    void clear();
+
+    // Number of selected items conflicting with item i
+    item_index_t blocked_by(item_index_t i) const { return m_blocked[i]; }
+    bool blocked(item_index_t i) const { return m_blocked[i] > 0; }
+
+    // The only selected item conflicting with item i. Only meaningful when blocked_by(i) == 1.
+    item_index_t blocker(item_index_t i) const { return m_blockers[i]; }
+
+    bool fits(item_index_t i) const { return m_soln->w + m_instance->weight(i) <= m_instance->capacity(); }
+
+    // Can item i be added without breaking any constraint?
+    bool can_add(item_index_t i) const { return not m_soln->x[i] && not blocked(i) && fits(i); }
+
+    void add(item_index_t i) {
+        m_soln->x.set(i);
+        m_soln->p += m_instance->profit(i);
+        m_soln->w += m_instance->weight(i);
+        for (item_index_t j : m_instance->conflicts(i)) {
+            ++m_blocked[j];
+            m_blockers[j] ^= i;
+        }
+    }
+
+    void remove(item_index_t i) {
+        m_soln->x.reset(i);
+        m_soln->p -= m_instance->profit(i);
+        m_soln->w -= m_instance->weight(i);
+        for (item_index_t j : m_instance->conflicts(i)) {
+            --m_blocked[j];
+            m_blockers[j] ^= i;
+        }
+    }
+};
+
+} // namespace dckp_ienum
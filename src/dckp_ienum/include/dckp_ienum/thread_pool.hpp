@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dckp_ienum {
+
+/*
+Fixed set of worker threads consuming a FIFO of tasks.
+The destructor runs the tasks still queued, then joins the workers.
+*/
+class ThreadPool {
+    std::vector<std::thread> m_workers;
+    std::deque<std::packaged_task<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping = false;
+
+    void run_worker();
+
+public:
+    // num_threads = 0 uses one thread per hardware thread
+    explicit ThreadPool(unsigned num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t num_threads() const { return m_workers.size(); }
+
+    // The future rethrows any exception thrown by the task
+    std::future<void> submit(std::function<void()> task);
+
+    static unsigned hardware_threads();
+};
+
+} // namespace dckp_ienum
@@ -1,7 +1,16 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <limits>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif // __AVX2__
 
 namespace dckp_ienum {
 
@@ -11,6 +20,10 @@ using conflict_index_t = unsigned int;
 using int_weight_t = unsigned int;
 using int_profit_t = unsigned int;
 
+// Sums of weights or profits over many items, which may not fit the item types
+using weight_sum_t = std::uint64_t;
+using profit_sum_t = std::uint64_t;
+
 template <typename T>
 struct Invalid;
 
@@ -28,8 +41,239 @@ template <typename T>
 constexpr T invalid_v = Invalid<T>::value;
 
 
+// Non-owning view over a contiguous array.
+template <typename T>
+class Span {
+    T* m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+    using const_iterator = T*;
+    using reverse_iterator = std::reverse_iterator<T*>;
+    using const_reverse_iterator = std::reverse_iterator<T*>;
+
+    Span() = default;
+    Span(T* data, std::size_t size) : m_data(data), m_size(size) {}
+    Span(T* begin, T* end) : m_data(begin), m_size(static_cast<std::size_t>(end - begin)) {}
+
+    T* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    T& operator[](std::size_t i) const { return m_data[i]; }
+
+    iterator begin() const { return m_data; }
+    iterator end() const { return m_data + m_size; }
+    reverse_iterator rbegin() const { return reverse_iterator(end()); }
+    reverse_iterator rend() const { return reverse_iterator(begin()); }
+};
+
+
+/*
+Dynamic bitset stored in 64-bit words, so that set operations work a word (or a SIMD register) at a time.
+Bits past size() are always zero, so bitsets of different sizes can be combined word by word.
+Resizing within the reserved capacity never allocates, so a bitset sized once for the instance can be
+reused for every node of a search.
+*/
+class Bitset {
+public:
+    using word_t = std::uint64_t;
+    static constexpr std::size_t WORD_BITS = 64;
+
+    static constexpr std::size_t num_words(std::size_t num_bits) {
+        return (num_bits + WORD_BITS - 1) / WORD_BITS;
+    }
+
+    class reference {
+        word_t& m_word;
+        word_t m_mask;
+
+    public:
+        reference(word_t& word, word_t mask) : m_word(word), m_mask(mask) {}
+
+        operator bool() const { return (m_word & m_mask) != 0; }
+        reference& operator=(bool value) {
+            m_word = value ? (m_word | m_mask) : (m_word & ~m_mask);
+            return *this;
+        }
+        reference& operator=(const reference& other) { return *this = static_cast<bool>(other); }
+    };
+
+private:
+    std::vector<word_t> m_words;
+    std::size_t m_size = 0;
+
+    static word_t mask(std::size_t i) { return word_t(1) << (i % WORD_BITS); }
+
+    // Mask of the bits of a word before position i (i % WORD_BITS == 0 means the whole word)
+    static word_t low_mask(std::size_t i) {
+        return i % WORD_BITS == 0 ? ~word_t(0) : (word_t(1) << (i % WORD_BITS)) - 1;
+    }
+    // Mask of the bits of a word at or after position i
+    static word_t high_mask(std::size_t i) {
+        return ~word_t(0) << (i % WORD_BITS);
+    }
+
+    // Zero the unused bits of the last word
+    void trim() {
+        if (m_size % WORD_BITS != 0) {
+            m_words.back() &= low_mask(m_size);
+        }
+    }
+
+    // Set or clear the bits in [begin, end)
+    template <bool Value>
+    void fill_range(std::size_t begin, std::size_t end) {
+        if (begin >= end) {
+            return;
+        }
+        const std::size_t first = begin / WORD_BITS;
+        const std::size_t last = (end - 1) / WORD_BITS;
+
+        for (std::size_t k = first; k <= last; ++k) {
+            word_t m = ~word_t(0);
+            if (k == first) {
+                m &= high_mask(begin);
+            }
+            if (k == last) {
+                m &= low_mask(end);
+            }
+            m_words[k] = Value ? (m_words[k] | m) : (m_words[k] & ~m);
+        }
+    }
+
+public:
+    Bitset() = default;
+    explicit Bitset(std::size_t size, bool value = false) {
+        resize(size, value);
+    }
+
+    std::size_t size() const { return m_size; }
+    std::size_t num_words() const { return m_words.size(); }
+    const word_t* data() const { return m_words.data(); }
+    word_t* data() { return m_words.data(); }
+
+    void reserve(std::size_t capacity) { m_words.reserve(num_words(capacity)); }
+
+    void resize(std::size_t size, bool value = false) {
+        if (value && size > m_size) {
+            // Set the tail of the current last word, new words are filled below
+            if (m_size % WORD_BITS != 0) {
+                m_words.back() |= high_mask(m_size);
+            }
+        }
+        m_words.resize(num_words(size), value ? ~word_t(0) : word_t(0));
+        m_size = size;
+        trim();
+    }
+
+    // Keep the size, take the first prefix bits from other and clear the others
+    void assign_prefix(const Bitset& other, std::size_t prefix) {
+        const std::size_t full_words = prefix / WORD_BITS;
+        std::copy(other.m_words.begin(), other.m_words.begin() + full_words, m_words.begin());
+        std::fill(m_words.begin() + full_words, m_words.end(), word_t(0));
+        if (prefix % WORD_BITS != 0) {
+            m_words[full_words] = other.m_words[full_words] & low_mask(prefix);
+        }
+    }
+
+    bool operator[](std::size_t i) const { return (m_words[i / WORD_BITS] & mask(i)) != 0; }
+    reference operator[](std::size_t i) { return { m_words[i / WORD_BITS], mask(i) }; }
+
+    void set(std::size_t i) { m_words[i / WORD_BITS] |= mask(i); }
+    void reset(std::size_t i) { m_words[i / WORD_BITS] &= ~mask(i); }
+
+    void set_range(std::size_t begin, std::size_t end) { fill_range<true>(begin, end); }
+    void reset_range(std::size_t begin, std::size_t end) { fill_range<false>(begin, end); }
+
+    // Clear all the bits
+    void reset() { std::fill(m_words.begin(), m_words.end(), word_t(0)); }
+
+    // Number of set bits
+    std::size_t count() const {
+        std::size_t ans = 0;
+        for (word_t word : m_words) {
+            ans += static_cast<std::size_t>(__builtin_popcountll(word));
+        }
+        return ans;
+    }
+
+    // Position of the first set bit at or after i, or size() if there is none
+    std::size_t find_next(std::size_t i) const {
+        if (i >= m_size) {
+            return m_size;
+        }
+        std::size_t k = i / WORD_BITS;
+        word_t word = m_words[k] & high_mask(i);
+        while (word == 0) {
+            if (++k == m_words.size()) {
+                return m_size;
+            }
+            word = m_words[k];
+        }
+        return k * WORD_BITS + static_cast<std::size_t>(__builtin_ctzll(word));
+    }
+
+    // Call f(i) for each set bit i, in increasing order
+    template <typename F>
+    void for_each(F&& f) const {
+        for (std::size_t k = 0; k < m_words.size(); ++k) {
+            for (word_t word = m_words[k]; word != 0; word &= word - 1) {
+                f(k * WORD_BITS + static_cast<std::size_t>(__builtin_ctzll(word)));
+            }
+        }
+    }
+
+    // Is any bit set both in this bitset and in the given words (which may be longer than this bitset)?
+    bool intersects(const word_t* other) const {
+        return words_intersect(m_words.data(), other, m_words.size());
+    }
+
+    // Same as intersects, only considering the bits before position end
+    bool intersects(const word_t* other, std::size_t end) const {
+        end = std::min(end, m_size);
+        const std::size_t full_words = end / WORD_BITS;
+        if (words_intersect(m_words.data(), other, full_words)) {
+            return true;
+        }
+        if (end % WORD_BITS == 0) {
+            return false;
+        }
+        return (m_words[full_words] & other[full_words] & low_mask(end)) != 0;
+    }
+
+    static bool words_intersect(const word_t* a, const word_t* b, std::size_t count) {
+        std::size_t k = 0;
+#ifdef __AVX2__
+        for (; k + 4 <= count; k += 4) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + k));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + k));
+            if (not _mm256_testz_si256(va, vb)) {
+                return true;
+            }
+        }
+#else
+        // Branch once every four words, the OR-reduction maps to SSE2 registers
+        for (; k + 4 <= count; k += 4) {
+            if (((a[k] & b[k]) | (a[k + 1] & b[k + 1]) | (a[k + 2] & b[k + 2]) | (a[k + 3] & b[k + 3])) != 0) {
+                return true;
+            }
+        }
+#endif // __AVX2__
+        for (; k < count; ++k) {
+            if ((a[k] & b[k]) != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+
 struct Solution {
-    std::vector<bool> x;
+    Bitset x;
     int_profit_t p = 0;
     int_weight_t w = 0;
 
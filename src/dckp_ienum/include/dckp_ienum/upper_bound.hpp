@@ -0,0 +1,13 @@
+#pragma once
+
+namespace dckp_ienum {
+
+// Upper bound of the subproblems, for the solvers that can use several
+enum class UpperBound {
+    Fkp,            // fractional knapsack, ignoring the conflicts
+    CliqueFkp,      // multiple-choice fractional knapsack over a clique partition, at most one item per clique
+    Ldckp,          // Lagrangian relaxation of the conflicts
+    LdckpCliques,   // Lagrangian relaxation of the clique inequalities of a clique cover
+};
+
+} // namespace dckp_ienum
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <numeric>
+
+#include <dckp_ienum/clique_cover.hpp>
+#include <dckp_ienum/conflicts.hpp>
+#include <dckp_ienum/profiler.hpp>
+
+namespace dckp_ienum {
+
+CliqueCover::CliqueCover(const Instance& instance) {
+    profiler::ScopedTicToc tictoc("clique_cover");
+
+    const item_index_t n = instance.num_items();
+
+    // Edge (i, j) with i < j is covered[forward_offsets[i] + position of j in the forward conflicts of i]
+    std::vector<conflict_index_t> forward_offsets(n + 1, 0);
+    for (item_index_t i = 0; i < n; ++i) {
+        forward_offsets[i + 1] = forward_offsets[i] + instance.forward_conflicts(i).size();
+    }
+    Bitset covered;
+    covered.resize(forward_offsets[n]);
+
+    auto cover = [&](item_index_t i, item_index_t j) {
+        const ConflictList forward = instance.forward_conflicts(i);
+        covered[forward_offsets[i] + (std::lower_bound(forward.begin(), forward.end(), j) - forward.begin())] = true;
+    };
+
+    std::vector<std::vector<item_index_t>> cliques;
+    std::vector<item_index_t> candidates;   // positions in the forward conflicts of i
+    for (item_index_t i = 0; i < n; ++i) {
+        const ConflictList forward = instance.forward_conflicts(i);
+
+        for (std::size_t k = 0; k < forward.size(); ++k) {
+            if (covered[forward_offsets[i] + k]) {
+                continue;
+            }
+
+            // Seed with the edge (i, forward[k]), then grow with the common neighbours,
+            // preferring the ones whose edge with i is not covered yet
+            std::vector<item_index_t> clique { i, forward[k] };
+            candidates.clear();
+            for (std::size_t l = 0; l < forward.size(); ++l) {
+                if (l != k && items_conflict(instance, forward[k], forward[l])) {
+                    candidates.push_back(l);
+                }
+            }
+
+            while (not candidates.empty()) {
+                auto it = std::find_if(candidates.begin(), candidates.end(), [&](item_index_t l) {
+                    return not covered[forward_offsets[i] + l];
+                });
+                const item_index_t next = forward[it == candidates.end()? candidates.front() : *it];
+                clique.push_back(next);
+
+                candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](item_index_t l) {
+                    return forward[l] == next || not items_conflict(instance, next, forward[l]);
+                }), candidates.end());
+            }
+
+            std::sort(clique.begin(), clique.end());
+            for (std::size_t a = 0; a < clique.size(); ++a) {
+                for (std::size_t b = a + 1; b < clique.size(); ++b) {
+                    cover(clique[a], clique[b]);
+                }
+            }
+
+            cliques.push_back(std::move(clique));
+        }
+    }
+
+    // By last item, so that the cliques involving the items from jp1 onwards are a suffix
+    std::stable_sort(cliques.begin(), cliques.end(), [](const auto& a, const auto& b) {
+        return a.back() < b.back();
+    });
+
+    m_offsets.reserve(cliques.size() + 1);
+    m_offsets.push_back(0);
+    for (const auto& clique : cliques) {
+        m_items.insert(m_items.end(), clique.begin(), clique.end());
+        m_offsets.push_back(m_items.size());
+    }
+
+    m_first.resize(n + 1);
+    conflict_index_t c = 0;
+    for (item_index_t i = 0; i <= n; ++i) {
+        while (c < cliques.size() && cliques[c].back() < i) {
+            ++c;
+        }
+        m_first[i] = c;
+    }
+}
+
+CliquePartition::CliquePartition(const Instance& instance) {
+    profiler::ScopedTicToc tictoc("clique_partition");
+
+    const item_index_t n = instance.num_items();
+
+    Bitset assigned;
+    assigned.resize(n);
+
+    std::vector<std::vector<item_index_t>> cliques;
+    for (item_index_t i = 0; i < n; ++i) {
+        if (assigned[i]) {
+            continue;
+        }
+
+        std::vector<item_index_t> clique { i };
+        assigned[i] = true;
+        for (item_index_t j : instance.forward_conflicts(i)) {
+            if (assigned[j]) {
+                continue;
+            }
+
+            bool all = true;
+            for (std::size_t k = 1; k < clique.size() && all; ++k) {
+                all = items_conflict(instance, clique[k], j);
+            }
+            if (all) {
+                clique.push_back(j);
+                assigned[j] = true;
+            }
+        }
+
+        cliques.push_back(std::move(clique));
+    }
+
+    // By last item, so that the cliques with items from jp1 onwards are a suffix
+    std::stable_sort(cliques.begin(), cliques.end(), [](const auto& a, const auto& b) {
+        return a.back() < b.back();
+    });
+
+    m_offsets.reserve(cliques.size() + 1);
+    m_offsets.push_back(0);
+    m_items.reserve(n);
+    for (const auto& clique : cliques) {
+        m_items.insert(m_items.end(), clique.begin(), clique.end());
+        m_offsets.push_back(m_items.size());
+    }
+
+    m_first.resize(n + 1);
+    conflict_index_t c = 0;
+    for (item_index_t i = 0; i <= n; ++i) {
+        while (c < cliques.size() && cliques[c].back() < i) {
+            ++c;
+        }
+        m_first[i] = c;
+    }
+}
+
+} // namespace dckp_ienum
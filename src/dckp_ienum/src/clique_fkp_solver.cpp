@@ -0,0 +1,148 @@
+#include <algorithm>
+
+#include <dckp_ienum/clique_fkp_solver.hpp>
+#include <dckp_ienum/profiler.hpp>
+
+namespace dckp_ienum {
+
+void CliqueFkpResult::convert(const Instance& instance, Solution &soln, item_index_t jp1) {
+    profiler::ScopedTicToc tictoc("convert_clique_fkp");
+
+    soln.p = profit;
+    soln.w = weight;
+    soln.ub = ub;
+
+    soln.x.reset_range(jp1, instance.num_items());
+    for (item_index_t i : taken) {
+        soln.x[i] = true;
+    }
+}
+
+void solve_clique_fkp(const Instance& instance, const CliquePartition& cliques, const Bitset& fixed_items, item_index_t jp1, int_profit_t fixed_p, int_weight_t fixed_w, CliqueFkpWorkspace& workspace, CliqueFkpResult& ans) {
+    profiler::ScopedTicToc tictoc("solve_clique_fkp");
+
+    using Increment = CliqueFkpWorkspace::Increment;
+
+    const item_index_t n = instance.num_items();
+    const int_weight_t residual = fixed_w < instance.capacity()? instance.capacity() - fixed_w : 0;
+
+    // Stamps instead of clearing: blocked[i] == epoch if item i conflicts with a fixed item
+    std::vector<std::uint32_t>& blocked = workspace.m_blocked;
+    if (blocked.size() != n) {
+        blocked.assign(n, 0);
+        workspace.m_epoch = 0;
+    }
+    if (++workspace.m_epoch == 0) {
+        std::fill(blocked.begin(), blocked.end(), 0);
+        workspace.m_epoch = 1;
+    }
+    const std::uint32_t epoch = workspace.m_epoch;
+
+    {
+        profiler::ScopedTicToc tictoc("clique_fkp_blocked");
+        for (item_index_t f = 0; f < jp1; ++f) {
+            if (fixed_items[f]) {
+                const ConflictList forward = instance.forward_conflicts(f);
+                for (auto it = std::lower_bound(forward.begin(), forward.end(), jp1); it != forward.end(); ++it) {
+                    blocked[*it] = epoch;
+                }
+            }
+        }
+    }
+
+    // The upper concave hull of the (weight, profit) points of each clique, as increments from the origin
+    std::vector<Increment>& increments = workspace.m_increments;
+    std::vector<item_index_t>& hull = workspace.m_clique;
+    increments.clear();
+    {
+        profiler::ScopedTicToc tictoc("clique_fkp_hulls");
+
+        for (conflict_index_t c = cliques.first_clique(jp1); c < cliques.num_cliques(); ++c) {
+            hull.clear();
+            for (item_index_t i : cliques.clique(c)) {
+                if (i >= jp1 && blocked[i] != epoch && instance.profit(i) > 0 && instance.weight(i) <= residual) {
+                    hull.push_back(i);
+                }
+            }
+            if (hull.empty()) {
+                continue;
+            }
+
+            std::sort(hull.begin(), hull.end(), [&](item_index_t a, item_index_t b) {
+                return instance.weight(a) < instance.weight(b) || (instance.weight(a) == instance.weight(b) && instance.profit(a) > instance.profit(b));
+            });
+
+            // Keep the points with increasing profit and decreasing slope (monotone chain, in place)
+            std::size_t h = 0;
+            for (item_index_t i : hull) {
+                const float_t w = instance.weight(i);
+                const float_t p = instance.profit(i);
+                if (h > 0 && p <= instance.profit(hull[h - 1])) {
+                    continue;
+                }
+
+                while (h > 0) {
+                    const float_t prev_w = h > 1? instance.weight(hull[h - 2]) : 0;
+                    const float_t prev_p = h > 1? instance.profit(hull[h - 2]) : 0;
+                    const float_t last_w = instance.weight(hull[h - 1]);
+                    const float_t last_p = instance.profit(hull[h - 1]);
+                    // Is the last point on or below the segment from the previous one to i?
+                    if ((last_p - prev_p) * (w - prev_w) <= (p - prev_p) * (last_w - prev_w)) {
+                        --h;
+                    } else {
+                        break;
+                    }
+                }
+                hull[h++] = i;
+            }
+
+            for (std::size_t k = 0; k < h; ++k) {
+                const int_weight_t prev_w = k > 0? instance.weight(hull[k - 1]) : 0;
+                const int_profit_t prev_p = k > 0? instance.profit(hull[k - 1]) : 0;
+                increments.push_back({ instance.weight(hull[k]) - prev_w, instance.profit(hull[k]) - prev_p, hull[k], k > 0? hull[k - 1] : invalid_v<item_index_t> });
+            }
+        }
+    }
+
+    // Greedily by decreasing profit / weight. The increments of a clique have decreasing ratios,
+    // so they are taken in order and each replaces the item of the previous one.
+    ans.profit = fixed_p;
+    ans.weight = fixed_w;
+    ans.taken.clear();
+    {
+        profiler::ScopedTicToc tictoc("clique_fkp_fill");
+
+        std::sort(increments.begin(), increments.end(), [](const Increment& a, const Increment& b) {
+            return static_cast<float_t>(a.profit) * static_cast<float_t>(b.weight) > static_cast<float_t>(b.profit) * static_cast<float_t>(a.weight);
+        });
+
+        // Replaced items are marked with the epoch too, they are never blocked
+        int_weight_t capacity = residual;
+        ans.ub = invalid_v<int_profit_t>;
+        for (const Increment& inc : increments) {
+            if (inc.weight <= capacity) {
+                capacity -= inc.weight;
+                ans.profit += inc.profit;
+                ans.weight += inc.weight;
+                ans.taken.push_back(inc.item);
+                if (inc.replaces != invalid_v<item_index_t>) {
+                    blocked[inc.replaces] = epoch;
+                }
+            } else {
+                const float_t fraction = static_cast<float_t>(capacity) / static_cast<float_t>(inc.weight);
+                ans.ub = ans.profit + static_cast<int_profit_t>(fraction * static_cast<float_t>(inc.profit));
+                break;
+            }
+        }
+        if (ans.ub == invalid_v<int_profit_t>) {
+            // Everything fits
+            ans.ub = ans.profit;
+        }
+
+        ans.taken.erase(std::remove_if(ans.taken.begin(), ans.taken.end(), [&](item_index_t i) {
+            return blocked[i] == epoch;
+        }), ans.taken.end());
+    }
+}
+
+} // namespace dckp_ienum
@@ -1,222 +1,697 @@
+#include <dckp_ienum/clique_fkp_solver.hpp>
 #include <dckp_ienum/fkp_solver.hpp>
 #include "dckp_ienum/profiler.hpp"
 #include "dckp_ienum/solution_ldckp_to_dckp.hpp"
 #include "dckp_ienum/solution_sanity_check.hpp"
 #include <dckp_ienum/conflicts.hpp>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <future>
+#include <mutex>
 #include <queue>
-#include <variant>
 #include <boost/pool/object_pool.hpp>
 
 #include <boost/pool/pool_alloc.hpp>
 #include <boost/container/flat_set.hpp>
 #include <dckp_ienum/types.hpp>
 #include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/bucket_queue.hpp>
+#include <dckp_ienum/dckp_bnb_solver.hpp>
 #include <dckp_ienum/ldckp_solver.hpp>
+#include <dckp_ienum/node_arena.hpp>
+#include <dckp_ienum/shared_incumbent.hpp>
 #include <dckp_ienum/solution_greedy_improvement.hpp>
+#include <dckp_ienum/thread_pool.hpp>
 
 namespace dckp_ienum {
 
-using NodeId = std::vector<bool>;
 using ItemSet = boost::container::flat_set<item_index_t>;
 
 struct Node {
-    NodeId id;
+    // Items 0..depth-1 are fixed, the ones taken are the path in the NodeArena
+    node_index_t path = NodeArena::empty;
+    item_index_t depth = 0;
     int_profit_t upper_bound;
     int_profit_t profit = 0;
     int_weight_t weight = 0;
 
+    // Critical item of the FKP bound of the node, where the search for the bounds of its children starts
+    item_index_t fkp_critical = invalid_v<item_index_t>;
+
+    // Multipliers of the LDCKP bound of the node, where the relaxations of its children start
+    LdckpMultipliers multipliers;
+
     Node(int_profit_t ub) : upper_bound(ub) {}
+};
+
+// A node handed over to another thread, with its path as a bitset as the arenas are per thread
+struct DetachedNode {
+    Node node { 0 };
+    Bitset x;
 
     struct UpperBoundLt {
-        bool operator()(const Node& a, const Node& b) const {
-            return a.upper_bound < b.upper_bound;
+        bool operator()(const DetachedNode& a, const DetachedNode& b) const {
+            return a.node.upper_bound < b.node.upper_bound;
         }
     };
 };
 
-void solve_dckp_bnb(const dckp_ienum::Instance& instance, Solution& soln, bool use_ldckp, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback) {
-    profiler::ScopedTicToc tictoc("solve_dckp_bnb");
+// No bound is larger, so no larger key is needed in the queue of the open nodes
+static profit_sum_t total_profit(const Instance& instance) {
+    profit_sum_t ans = 0;
+    for (item_index_t i = 0; i < instance.num_items(); ++i) {
+        ans += instance.profit(i);
+    }
+    return ans;
+}
+
+/*
+Open nodes of a best-first search, with everything needed to expand them: the arena of their paths and the buffers
+of the bounds. The clique cover and partition are only read, so they can be shared by the searches of several threads.
+
+When the open nodes take more than the memory budget, the nodes that cannot beat the incumbent are dropped and, if that
+is not enough, the search dives: the subtree of the best open node is explored depth-first, on a stack of O(depth) nodes,
+so that the heap does not grow. Best-first resumes after the dive, or as soon as a better incumbent frees enough memory.
+*/
+class BnbSearch {
+    const Instance& m_instance;
+    const UpperBound m_bound;
+    const bool m_use_ldckp;
+    const CliqueCover& m_cliques;
+    const CliquePartition& m_partition;
+    const std::size_t m_memory_budget;
+    const bool m_propagate;
+
+    // Reused by the bounds of all the nodes, so that computing them does not allocate
+    LdckpWorkspace m_ldckp_workspace;
+    LdckpResult m_ldckp_result;
+    FkpResult m_fkp_result;
+    CliqueFkpWorkspace m_clique_fkp_workspace;
+    CliqueFkpResult m_clique_fkp_result;
+
+    Solution m_soln_temp;
+
+    // The paths of the open nodes, only rebuilt into m_node_x when a node is expanded
+    NodeArena m_arena;
+    Bitset m_node_x;
+
+    // Best-first by upper bound, ties broken depth-first (the last child pushed comes out first)
+    BucketQueue<Node> m_queue;
+
+    // Open nodes of the current dive, the most promising one last
+    std::vector<Node> m_dive;
+    bool m_diving = false;  // whether the node being expanded comes from m_dive, so its children go there
+
+    // Bytes held by the open nodes beyond sizeof(Node)
+    std::size_t m_multiplier_bytes = 0;
+
+    // Incumbent profit of the last purge, so that the heap is only purged again after it improves
+    int_profit_t m_purged = 0;
+
+    // Evaluate the child of node fixing item j to value, and push it if it may beat soln.p
+    void eval_child(const Node& node, bool value, Solution& soln, bool& improved);
+
+    static std::size_t extra_bytes(const Node& node) { return node.multipliers.capacity() * sizeof(LdckpMultiplier); }
+
+    bool over_budget() const { return m_memory_budget > 0 && memory_usage() > m_memory_budget; }
+
+    // Drop the nodes of the heap that cannot beat lower_bound
+    void purge(int_profit_t lower_bound);
+
+    Node pop_best() {
+        Node node = m_queue.pop();
+        m_multiplier_bytes -= extra_bytes(node);
+        return node;
+    }
+
+    void push_open(Node&& node) {
+        m_multiplier_bytes += extra_bytes(node);
+        const int_profit_t ub = node.upper_bound;
+        m_queue.push(ub, std::move(node));
+    }
+
+public:
+    BnbSearch(const Instance& instance, UpperBound bound, const CliqueCover& cliques, const CliquePartition& partition, const BnbParams& params);
+
+    bool empty() const { return m_queue.empty() && m_dive.empty(); }
+    std::size_t size() const { return m_queue.size() + m_dive.size(); }
+
+    // Whether the last node popped comes from a dive rather than from the best-first heap
+    bool diving() const { return m_diving; }
+
+    // Bytes held by the open nodes and their paths
+    std::size_t memory_usage() const { return size() * sizeof(Node) + m_multiplier_bytes + m_arena.memory_usage(); }
+
+    // Bound of the best open node
+    int_profit_t upper_bound() const {
+        int_profit_t ans = 0;
+        m_queue.for_each_top([&](const Node& node) {
+            ans = std::max(ans, node.upper_bound);
+        });
+        for (const Node& node : m_dive) {
+            ans = std::max(ans, node.upper_bound);
+        }
+        return ans;
+    }
+
+    // Open the node with no items fixed
+    void push_root() {
+        push_open(Node(std::numeric_limits<int_profit_t>::max()));
+    }
+
+    // Next node to expand: the best open one, or the next one of the dive. lower_bound is the incumbent profit.
+    Node pop(int_profit_t lower_bound);
+
+    /*
+    Expand a node taken from pop(), pushing its children that may beat soln.p.
+    soln is replaced by the better solutions found on the way; returns whether it was.
+    */
+    bool expand(const Node& node, Solution& soln);
+
+    // Take the best open node (or the shallowest one of the dive) out of this search
+    DetachedNode detach();
+
+    // Open a node taken out of another search
+    void attach(DetachedNode&& detached);
+};
+
+BnbSearch::BnbSearch(const Instance& instance, UpperBound bound, const CliqueCover& cliques, const CliquePartition& partition, const BnbParams& params) :
+    m_instance(instance),
+    m_bound(bound),
+    m_use_ldckp(bound == UpperBound::Ldckp || bound == UpperBound::LdckpCliques),
+    m_cliques(cliques),
+    m_partition(partition),
+    m_memory_budget(params.memory_budget),
+    m_propagate(params.propagate),
+    m_queue(total_profit(instance))
+{
+    m_soln_temp.x.resize(instance.num_items());
+    m_soln_temp.ub = std::numeric_limits<int_profit_t>::max();
+    m_node_x.resize(instance.num_items());
+
+    if (m_use_ldckp) {
+        m_ldckp_workspace.reserve(instance, bound == UpperBound::LdckpCliques? &cliques : nullptr);
+        m_ldckp_result.x.resize(instance.num_items());
+    }
+}
+
+void BnbSearch::purge(int_profit_t lower_bound) {
+    profiler::ScopedTicToc tictoc("purge_nodes");
+
+    m_purged = lower_bound;
+    m_queue.remove_if([&](const Node& node) {
+        if (node.upper_bound > lower_bound) {
+            return false;
+        }
+        m_arena.release(node.path);
+        m_multiplier_bytes -= extra_bytes(node);
+        return true;
+    });
+}
+
+Node BnbSearch::pop(int_profit_t lower_bound) {
+    profiler::ScopedTicToc tictoc("dequeue_node");
+
+    if (m_dive.empty() && over_budget()) {
+        if (lower_bound > m_purged) {
+            purge(lower_bound);
+        }
+        if (over_budget() && not m_queue.empty()) {
+            // Dive into the subtree of the best open node
+            m_dive.push_back(pop_best());
+            m_multiplier_bytes += extra_bytes(m_dive.back());
+        }
+    }
+
+    m_diving = not m_dive.empty();
+    if (not m_diving) {
+        return pop_best();
+    }
+
+    Node node(std::move(m_dive.back()));
+    m_dive.pop_back();
+    m_multiplier_bytes -= extra_bytes(node);
+    return node;
+}
+
+bool BnbSearch::expand(const Node& node, Solution& soln) {
+    const Instance& instance = m_instance;
+    bool improved = false;
+
+    const item_index_t j = node.depth;
+    if (j >= instance.num_items()) {
+        if (node.profit > soln.p) {
+            m_arena.path(node.path, m_node_x);
+            soln.w = node.weight;
+            soln.p = node.profit;
+            soln.x = m_node_x;
+            improved = true;
+        }
+        m_arena.release(node.path);
+        return improved;
+    }
+
+    // Check the upper bound again in case the best profit changed
+    if (node.upper_bound <= soln.p) {
+        m_arena.release(node.path);
+        return improved;
+    }
+
+    {
+        profiler::ScopedTicToc tictoc("node_path");
+        m_arena.path(node.path, m_node_x);
+    }
+
+    const std::size_t dive_size = m_dive.size();
+    {
+        profiler::ScopedTicToc tictoc("eval_false");
+        eval_child(node, false, soln, improved);
+    }
+    {
+        profiler::ScopedTicToc tictoc("eval_true");
+        eval_child(node, true, soln, improved);
+    }
+
+    // The children (if any) hold their own references to the node
+    m_arena.release(node.path);
+
+    if (m_diving) {
+        // Go on with the most promising child
+        if (m_dive.size() == dive_size + 2 && m_dive[dive_size].upper_bound > m_dive[dive_size + 1].upper_bound) {
+            std::swap(m_dive[dive_size], m_dive[dive_size + 1]);
+        }
+
+        // A better incumbent may free enough memory to go back to best-first
+        if (improved) {
+            purge(soln.p);
+            if (not over_budget()) {
+                while (not m_dive.empty()) {
+                    Node open(std::move(m_dive.back()));
+                    m_dive.pop_back();
+                    m_multiplier_bytes -= extra_bytes(open);
+                    push_open(std::move(open));
+                }
+                m_diving = false;
+            }
+        }
+    }
+
+    return improved;
+}
+
+void BnbSearch::eval_child(const Node& node, bool value, Solution& soln, bool& improved) {
+    const Instance& instance = m_instance;
+    Solution& soln_temp = m_soln_temp;
+    const item_index_t j = node.depth;
+
+    soln_temp.p = node.profit;
+    soln_temp.w = node.weight;
+
+    if (value) {
+        soln_temp.p += instance.profit(j);
+        soln_temp.w += instance.weight(j);
+
+        if (soln_temp.p > node.upper_bound) {
+            return;
+        }
+
+        if (soln_temp.w > instance.capacity()) {
+            return;
+        }
+
+        if (check_backward_conflict(instance, m_node_x, j)) {
+            return;
+        }
+    }
+
+    // Prepare the solution vector (no allocation, soln_temp.x is already sized for the instance)
+    soln_temp.x.assign_prefix(m_node_x, j);
+    soln_temp.x[j] = value;
+
+    #ifdef ENABLE_CHECKS
+    for (item_index_t i = 0; i < j; ++i) {
+        if (m_node_x[i] != soln_temp.x[i]) {
+            throw std::runtime_error("broken id copy");
+        }
+    }
+    #endif // ENABLE_CHECKS
+
+    // The child branches on the next item that can still be taken: the ones in between conflict with an item taken
+    // or do not fit anymore, so they are fixed out here instead of each making a node with a single child
+    item_index_t jp1 = j + 1;
+    if (m_propagate) {
+        profiler::ScopedTicToc tictoc("propagate");
+        const int_weight_t residual = instance.capacity() - soln_temp.w;
+        while (jp1 < instance.num_items() && (instance.weight(jp1) > residual || check_backward_conflict(instance, soln_temp.x, jp1))) {
+            ++jp1;
+        }
+    }
+
+    // Compute a solution to the relaxed problem
+    if (m_use_ldckp) {
+        // The relaxation of a child is the one of its parent with an item fixed, so start from its multipliers
+        const LdckpMultipliers* warm_start = j > 0? &node.multipliers : nullptr;
+        LdckpSolverParams params;
+        params.lower_bound = soln.p;
+        if (m_bound == UpperBound::LdckpCliques) {
+            params.cliques = &m_cliques;
+        }
+        dckp_ienum::solve_ldckp(instance, soln_temp.x, jp1, soln_temp.p, soln_temp.w, params, m_ldckp_workspace, m_ldckp_result, warm_start);
+        soln_temp.ub = m_ldckp_result.int_ub();
+    } else {
+        // Fixing item j moves the critical item by a few positions at most, if at all
+        m_fkp_result = solve_fkp_fast(instance, jp1, soln_temp.p, soln_temp.w, node.fkp_critical);
+        soln_temp.ub = m_fkp_result.ub;
+
+        // The multiple-choice bound is never looser, only compute it if FKP does not prune already
+        if (m_bound == UpperBound::CliqueFkp && soln_temp.ub >= soln.p) {
+            solve_clique_fkp(instance, m_partition, soln_temp.x, jp1, soln_temp.p, soln_temp.w, m_clique_fkp_workspace, m_clique_fkp_result);
+            soln_temp.ub = m_clique_fkp_result.ub;
+        }
+    }
+
+    // Is this problem at least as promising as the current best solution?
+    if (soln_temp.ub < soln.p) {
+        return;
+    }
+
+    bool use_solution = true;
+    if (use_solution) {
+        // Compute a feasible solution from the relaxed one
+        if (m_use_ldckp) {
+            m_ldckp_result.convert(instance, soln_temp, jp1);
+        } else if (m_bound == UpperBound::CliqueFkp) {
+            m_clique_fkp_result.convert(instance, soln_temp, jp1);
+        } else {
+            m_fkp_result.convert(instance, soln_temp, jp1);
+        }
+
+        #ifdef ENABLE_CHECKS
+        // The Lagrangian solution may break conflicts, so its profit can exceed L(lambda): only check it once they are removed
+        if (not m_use_ldckp) {
+            std::cout << "convert check" << std::endl;
+            dckp_ienum::solution_sanity_check(soln_temp, instance, false);
+        }
+        #endif // ENABLE_CHECKS
+
+        // Greedily drop items (idx >= jp1) that break conflicts (drop the ones with worse p/w ratio)
+        solution_greedy_remove_conflicts(instance, soln_temp, jp1);
+
+        #ifdef ENABLE_CHECKS
+        std::cout << "drop check" << std::endl;
+        dckp_ienum::solution_sanity_check(soln_temp, instance);
+        #endif // ENABLE_CHECKS
+
+        // Greedily take items to improve the solution
+        solution_greedy_improve(instance, soln_temp, jp1);
+
+        #ifdef ENABLE_CHECKS
+        std::cout << "greedy check" << std::endl;
+        dckp_ienum::solution_sanity_check(soln_temp, instance);
+        #endif // ENABLE_CHECKS
+
+        // If the solution found is better than the best, use it as new best
+        if (soln_temp.p > soln.p) {
+            soln.p = soln_temp.p;
+            soln.w = soln_temp.w;
+            soln.x = soln_temp.x;
+            improved = true;
+        }
+    }
+
+    profiler::tic("push_node");
+    // Push the node to the queue (or to the dive)
+    Node new_node(soln_temp.ub);
+    new_node.path = value? m_arena.push(node.path, j) : m_arena.acquire(node.path);
+    new_node.depth = jp1;
+    new_node.weight = node.weight;
+    new_node.profit = node.profit;
+    if (m_use_ldckp) {
+        new_node.multipliers = m_ldckp_result.multipliers;
+    } else {
+        new_node.fkp_critical = m_fkp_result.fractional_idx;
+    }
+    if (value) {
+        new_node.profit += instance.profit(j);
+        new_node.weight += instance.weight(j);
+    }
+
+    if (m_diving) {
+        m_multiplier_bytes += extra_bytes(new_node);
+        m_dive.push_back(std::move(new_node));
+    } else {
+        push_open(std::move(new_node));
+    }
+
+    profiler::toc("push_node");
+}
+
+DetachedNode BnbSearch::detach() {
+    DetachedNode ans;
+    if (m_queue.empty()) {
+        ans.node = std::move(m_dive.front());
+        m_dive.erase(m_dive.begin());
+        m_multiplier_bytes -= extra_bytes(ans.node);
+    } else {
+        ans.node = pop_best();
+    }
+    ans.x.resize(m_instance.num_items());
+    m_arena.path(ans.node.path, ans.x);
+    m_arena.release(ans.node.path);
+    ans.node.path = NodeArena::empty;
+    return ans;
+}
+
+void BnbSearch::attach(DetachedNode&& detached) {
+    detached.node.path = m_arena.push(detached.x);
+    push_open(std::move(detached.node));
+}
+
+// The cliques of the bound, if it uses any
+static void find_cliques(const Instance& instance, UpperBound bound, CliqueCover& cliques, CliquePartition& partition) {
+    if (bound == UpperBound::LdckpCliques) {
+        cliques = CliqueCover(instance);
+    }
+    if (bound == UpperBound::CliqueFkp) {
+        partition = CliquePartition(instance);
+    }
+}
 
-    const auto rconflicts_end = instance.rconflicts().end();
+void solve_dckp_bnb(const dckp_ienum::Instance& instance, Solution& soln, UpperBound bound, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const BnbParams& params) {
+    profiler::ScopedTicToc tictoc("solve_dckp_bnb");
 
     soln.p = 0;
     soln.w = 0;
-    std::fill(soln.x.begin(), soln.x.end(), false);
+    soln.x.reset();
 
-    Solution soln_temp;
-    soln_temp.x.reserve(instance.num_items());
-    soln_temp.ub = std::numeric_limits<int_profit_t>::max();
+    // Found once for the whole search
+    CliqueCover cliques;
+    CliquePartition partition;
+    find_cliques(instance, bound, cliques, partition);
 
-    std::vector<Node> queue;
-    queue.emplace_back(soln_temp.ub);
+    BnbSearch search(instance, bound, cliques, partition, params);
+    search.push_root();
 
-    while (not queue.empty()) {
+    while (not search.empty()) {
         if (*stop_token) {
             break;
         }
-        
-        // Move node out of the queue
-        profiler::tic("dequeue_node");
-        std::pop_heap(queue.begin(), queue.end(), Node::UpperBoundLt {});
-        const Node node(std::move(queue.back()));
-        queue.pop_back();
-        profiler::toc("dequeue_node");
+
+        const Node node = search.pop(soln.p);
 
         // Only for info purposes. The actual UB will be set at the end of the function.
-        soln.ub = node.upper_bound;
-
-        const item_index_t j = node.id.size();
-        if (j >= instance.num_items()) {
-            if (node.profit > soln.p) {
-                soln.w = node.weight;
-                soln.p = node.profit;
-                soln.x = node.id;
-                solution_callback(soln);
-            }
-            continue;
+        if (not search.diving()) {
+            soln.ub = node.upper_bound;
         }
 
-        // Check the upper bound again in case the best profit changed
-        if (node.upper_bound <= soln.p) {
-            continue;
+        if (search.expand(node, soln)) {
+            solution_callback(soln);
         }
+    }
 
-        // Find the position of j's conflicts
-        
-        auto jth_rconflicts_begin = find_conflict_iterator(instance.rconflicts(), j);
-        auto jp1th_conflicts_begin = find_conflict_iterator(instance.conflicts(), j+1);
-        
-        auto jp1th_rconflicts_begin = jth_rconflicts_begin;
-        advance_conflict_iterator(j+1, jp1th_rconflicts_begin, rconflicts_end);
-        
-        auto eval_soln = [&](bool value) {
-            auto rconflicts_it = jth_rconflicts_begin;
+    if (search.empty()) {
+        // Either the optimum was found or we have a bug :)
+        soln.ub = soln.p;
+    } else {
+        // Algorithm was terminated early, use the worst upper bound we have
+        soln.ub = search.upper_bound();
+    }
 
-            soln_temp.p = node.profit;
-            soln_temp.w = node.weight;
+    if (soln.p == 0) {
+        solution_callback(soln);
+    }
+}
 
-            if (value) {
-                soln_temp.p += instance.profit(j);
-                soln_temp.w += instance.weight(j);
+/*
+Nodes handed over between the threads of the parallel search.
+A thread that runs out of nodes waits here, and the others hand over their best open node while someone is waiting.
+The search is over when all the threads wait at the same time with no node to hand out.
+*/
+class NodeExchange {
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<DetachedNode> m_nodes;  // heap by upper bound
+    const unsigned m_num_workers;
+    unsigned m_waiting = 0;
+    bool m_done = false;
 
-                if (soln_temp.p > node.upper_bound) {
-                    return;
-                }
+    // Threads waiting minus nodes available, read without the lock
+    std::atomic<int> m_wanted = 0;
 
-                if (soln_temp.w > instance.capacity()) {
-                    return;
-                }
+public:
+    explicit NodeExchange(unsigned num_workers) : m_num_workers(num_workers) {}
 
-                if (check_conflict(node.id, j, rconflicts_it, rconflicts_end)) {
-                    return;
-                }
-            }
+    bool wanted() const { return m_wanted.load(std::memory_order_relaxed) > 0; }
 
-            // Prepare the solution vector
-            soln_temp.x = node.id;
-            soln_temp.x.resize(instance.num_items(), false);
-            soln_temp.x[j] = value;
+    void give(DetachedNode&& node) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_nodes.push_back(std::move(node));
+            std::push_heap(m_nodes.begin(), m_nodes.end(), DetachedNode::UpperBoundLt {});
+            m_wanted.fetch_sub(1, std::memory_order_relaxed);
+        }
+        m_cv.notify_one();
+    }
 
-            #ifdef ENABLE_CHECKS
-            if (not std::equal(node.id.begin(), node.id.end(), soln_temp.x.begin())) {
-                throw std::runtime_error("broken id copy");
-            }
-            #endif // ENABLE_CHECKS
-
-            // Compute a solution to the relaxed problem
-            std::variant<LdckpResult, FkpResult> result;
-            if (use_ldckp) {
-                result = dckp_ienum::solve_ldckp(instance, soln_temp.x, j+1, soln_temp.p, soln_temp.w, jp1th_rconflicts_begin, dckp_ienum::LdckpSolverParams {});
-            } else {
-                result = solve_fkp_fast(instance, j+1, soln_temp.p, soln_temp.w);
+    // Wait for a node. Returns false when the search is over or stopped.
+    bool take(DetachedNode& node, std::atomic<bool>* stop_token) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_waiting;
+        m_wanted.fetch_add(1, std::memory_order_relaxed);
+
+        while (m_nodes.empty() && not m_done && not *stop_token) {
+            if (m_waiting == m_num_workers) {
+                m_done = true;
+                m_cv.notify_all();
+                break;
             }
+            // The stop token is not notified, so poll it
+            m_cv.wait_for(lock, std::chrono::milliseconds(5));
+        }
 
-            std::visit([&](auto& arg) {
-                soln_temp.ub = arg.ub;
-            }, result);
+        --m_waiting;
+        if (m_nodes.empty()) {
+            m_wanted.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
 
-            // Is this problem at least as promising as the current best solution?
-            if (soln_temp.ub < soln.p) {
-                return;
-            }
+        // One thread less waiting and one node less available
+        std::pop_heap(m_nodes.begin(), m_nodes.end(), DetachedNode::UpperBoundLt {});
+        node = std::move(m_nodes.back());
+        m_nodes.pop_back();
+        return true;
+    }
 
-            bool use_solution = true;
-            if (use_solution) {
-                // Compute a feasible solution from the relaxed one
-                std::visit([&](auto& arg) {
-                    arg.convert(instance, soln_temp, j+1);
-                }, result);
-
-                #ifdef ENABLE_CHECKS
-                std::cout << "convert check" << std::endl;
-                dckp_ienum::solution_sanity_check(soln_temp, instance, false);
-                #endif // ENABLE_CHECKS
-
-                // Greedily drop items (idx > j) that break conflicts (drop the ones with worse p/w ratio)
-                solution_greedy_remove_conflicts(instance, soln_temp, j+1, jth_rconflicts_begin);
-                
-                #ifdef ENABLE_CHECKS
-                std::cout << "drop check" << std::endl;
-                dckp_ienum::solution_sanity_check(soln_temp, instance);
-                #endif // ENABLE_CHECKS
-                
-                // Greedily take items to improve the solution
-                solution_greedy_improve(instance, soln_temp, j+1, rconflicts_it, jp1th_conflicts_begin);
-    
-                #ifdef ENABLE_CHECKS
-                std::cout << "greedy check" << std::endl;
-                dckp_ienum::solution_sanity_check(soln_temp, instance);
-                #endif // ENABLE_CHECKS
-                
-                // If the solution found is better than the best, use it as new best
-                if (soln_temp.p > soln.p) {
-                    soln.p = soln_temp.p;
-                    soln.w = soln_temp.w;
-                    soln.x = soln_temp.x;
-                    solution_callback(soln);
-                }
-            }
+    // Bound of the best node waiting to be taken, or 0. Only called once the threads are done.
+    int_profit_t upper_bound() const {
+        return m_nodes.empty()? 0 : m_nodes.front().node.upper_bound;
+    }
+};
+
+static void run_worker(BnbSearch& search, NodeExchange& exchange, SharedIncumbent& incumbent, std::atomic<bool>* stop_token, Solution& best, BnbMtStats& stats) {
+    DetachedNode detached;
 
-            profiler::tic("push_node");
-            // Push the node to the queue
-            auto& new_node = queue.emplace_back(soln_temp.ub);
-            new_node.id = node.id;
-            new_node.id.resize(j + 1, value);
-            new_node.weight = node.weight;
-            new_node.profit = node.profit;
-            if (value) {
-                new_node.profit += instance.profit(j);
-                new_node.weight += instance.weight(j);
+    while (not *stop_token) {
+        if (search.empty()) {
+            if (not exchange.take(detached, stop_token)) {
+                break;
             }
+            search.attach(std::move(detached));
+        }
 
-            std::push_heap(queue.begin(), queue.end(), Node::UpperBoundLt {});
+        // Only the profit matters for pruning: x and w are replaced with it whenever this thread finds a better solution
+        best.p = std::max(best.p, incumbent.profit());
 
-            profiler::toc("push_node");
-        };
+        const Node node = search.pop(best.p);
+        ++stats.nodes;
+        if (search.expand(node, best)) {
+            incumbent.publish(best);
+        }
 
-        {
-            profiler::ScopedTicToc tictoc("eval_false");
-            eval_soln(false);
+        // Keep one node to go on with
+        if (exchange.wanted() && search.size() > 1) {
+            exchange.give(search.detach());
+            ++stats.handovers;
         }
-        {
-            profiler::ScopedTicToc tictoc("eval_true");
-            eval_soln(true);
+    }
+}
+
+BnbMtStats solve_dckp_bnb_mt(const dckp_ienum::Instance& instance, Solution& soln, UpperBound bound, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const BnbMtParams& params) {
+    profiler::ScopedTicToc tictoc("solve_dckp_bnb_mt");
+
+    soln.p = 0;
+    soln.w = 0;
+    soln.x.reset();
+
+    CliqueCover cliques;
+    CliquePartition partition;
+    find_cliques(instance, bound, cliques, partition);
+
+    SharedIncumbent incumbent(instance.num_items());
+
+    const unsigned num_threads = params.num_threads > 0? params.num_threads : ThreadPool::hardware_threads();
+    BnbParams search_params = params.bnb;
+    search_params.memory_budget /= num_threads;
+
+    std::vector<BnbSearch> searches;
+    searches.reserve(num_threads);
+    std::vector<Solution> best(num_threads);
+    for (unsigned k = 0; k < num_threads; ++k) {
+        searches.emplace_back(instance, bound, cliques, partition, search_params);
+        best[k].x.resize(instance.num_items());
+    }
+    searches[0].push_root();
+
+    NodeExchange exchange(num_threads);
+    std::vector<BnbMtStats> worker_stats(num_threads);
+
+    // Report the incumbent from this thread whenever it improves
+    auto report = [&]() {
+        if (incumbent.profit() > soln.p) {
+            incumbent.read(soln);
+            solution_callback(soln);
+        }
+    };
+
+    {
+        ThreadPool pool(num_threads);
+
+        std::vector<std::future<void>> futures;
+        for (unsigned k = 0; k < num_threads; ++k) {
+            futures.push_back(pool.submit([&, k]() {
+                run_worker(searches[k], exchange, incumbent, stop_token, best[k], worker_stats[k]);
+            }));
+        }
+
+        for (auto& future : futures) {
+            while (future.wait_for(std::chrono::milliseconds(5)) != std::future_status::ready) {
+                report();
+            }
+            future.get();
         }
     }
 
-    if (queue.empty()) {
-        // Either the optimum was found or we have a bug :)
-        soln.ub = soln.p;
-    } else {
-        // Algorithm was terminated early, use the worst upper bound we have
-        soln.ub = queue.front().upper_bound;
+    report();
+
+    // The threads only stop between two expansions, so every open node is in a search or in the exchange
+    soln.ub = std::max(soln.p, exchange.upper_bound());
+    for (const BnbSearch& search : searches) {
+        if (not search.empty()) {
+            soln.ub = std::max(soln.ub, search.upper_bound());
+        }
     }
 
     if (soln.p == 0) {
         solution_callback(soln);
     }
+
+    BnbMtStats stats;
+    for (const auto& s : worker_stats) {
+        stats += s;
+    }
+    return stats;
 }
 
-} // namespace dckp_ienum
\ No newline at end of file
+} // namespace dckp_ienum
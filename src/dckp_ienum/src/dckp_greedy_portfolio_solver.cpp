@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <numeric>
+
+#include <dckp_ienum/dckp_greedy_portfolio_solver.hpp>
+#include <dckp_ienum/profiler.hpp>
+#include <dckp_ienum/solution_state.hpp>
+#include <dckp_ienum/thread_pool.hpp>
+
+namespace dckp_ienum {
+
+static float_t item_score(const Instance& instance, const GreedyRule& rule, item_index_t i) {
+    const float_t p = instance.profit(i);
+    float_t w = instance.weight(i);
+    const ConflictList conflicts = instance.conflicts(i);
+
+    switch (rule.score) {
+        case GreedyScore::Ratio:
+            break;
+
+        case GreedyScore::DegreeRatio:
+            w *= 1 + conflicts.size();
+            break;
+
+        case GreedyScore::NeighbourWeight: {
+            float_t neighbour_weight = 0;
+            for (item_index_t j : conflicts) {
+                neighbour_weight += instance.weight(j);
+            }
+            w += rule.lambda * neighbour_weight;
+            break;
+        }
+    }
+    return p / w;
+}
+
+static void greedy_pass(const Instance& instance, const GreedyRule& rule, Solution& soln, std::atomic<bool>* stop_token) {
+    std::vector<item_index_t> order(instance.num_items());
+    std::iota(order.begin(), order.end(), 0);
+
+    // The items are already sorted by p/w
+    if (rule.score != GreedyScore::Ratio) {
+        std::vector<float_t> scores(instance.num_items());
+        for (item_index_t i = 0; i < instance.num_items(); ++i) {
+            scores[i] = item_score(instance, rule, i);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](item_index_t a, item_index_t b) {
+            return scores[a] > scores[b];
+        });
+    }
+
+    SolutionState state(instance, soln);
+    state.clear();
+
+    for (item_index_t i : order) {
+        if (*stop_token) {
+            break;
+        }
+        if (state.can_add(i)) {
+            state.add(i);
+        }
+    }
+}
+
+void solve_dckp_greedy_portfolio(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const GreedyPortfolioParams& params) {
+    profiler::ScopedTicToc tictoc("solve_dckp_greedy_portfolio");
+
+    const std::size_t num_rules = params.rules.size();
+    std::vector<Solution> results(num_rules);
+    for (auto& result : results) {
+        result.x.resize(instance.num_items());
+    }
+
+    {
+        unsigned num_threads = params.num_threads > 0? params.num_threads : ThreadPool::hardware_threads();
+        ThreadPool pool(std::min<std::size_t>(num_threads, std::max<std::size_t>(num_rules, 1)));
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(num_rules);
+        for (std::size_t k = 0; k < num_rules; ++k) {
+            futures.push_back(pool.submit([&, k]() {
+                greedy_pass(instance, params.rules[k], results[k], stop_token);
+            }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    }
+
+    // Keep the incumbent unless a rule beats it
+    bool improved = false;
+    for (auto& result : results) {
+        if (result.p > soln.p) {
+            soln.p = result.p;
+            soln.w = result.w;
+            soln.x = std::move(result.x);
+            improved = true;
+        }
+    }
+
+    if (improved || soln.p == 0) {
+        solution_callback(soln);
+    }
+}
+
+} // namespace dckp_ienum
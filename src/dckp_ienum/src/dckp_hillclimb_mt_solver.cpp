@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <random>
+#include <vector>
+
+#include <dckp_ienum/dckp_hillclimb_mt_solver.hpp>
+#include <dckp_ienum/profiler.hpp>
+#include <dckp_ienum/shared_incumbent.hpp>
+#include <dckp_ienum/solution_state.hpp>
+#include <dckp_ienum/thread_pool.hpp>
+
+namespace dckp_ienum {
+
+// Greedy in p/w order, skipping each item with probability skip_probability
+static void randomised_greedy(SolutionState& state, float_t skip_probability, std::mt19937_64& rng) {
+    std::bernoulli_distribution skip(skip_probability);
+
+    state.clear();
+    for (item_index_t i = 0; i < state.instance().num_items(); ++i) {
+        if (state.can_add(i) && not skip(rng)) {
+            state.add(i);
+        }
+    }
+}
+
+// Drop a random fraction of the items
+static void perturb(SolutionState& state, float_t strength, std::mt19937_64& rng) {
+    std::vector<item_index_t> selected;
+    state.solution().x.for_each([&](item_index_t i) { selected.push_back(i); });
+    if (selected.empty()) {
+        return;
+    }
+
+    std::size_t count = std::max<std::size_t>(1, strength * selected.size());
+    std::shuffle(selected.begin(), selected.end(), rng);
+    for (std::size_t k = 0; k < count; ++k) {
+        state.remove(selected[k]);
+    }
+}
+
+static HillclimbStats run_worker(const Instance& instance, unsigned worker, SharedIncumbent& incumbent, std::atomic<bool>* stop_token, const HillclimbMtParams& params) {
+    HillclimbStats stats;
+    std::mt19937_64 rng(params.seed + worker);
+    std::bernoulli_distribution from_incumbent(params.incumbent_restart_probability);
+    std::uniform_real_distribution<float_t> skip_probability(0.0, 0.5);
+
+    Solution soln;
+    soln.x.resize(instance.num_items());
+    SolutionState state(instance, soln);
+
+    auto no_callback = [](const Solution&) {};
+
+    HillclimbParams simple_params = params.hillclimb;
+    simple_params.compound_moves = false;
+
+    for (std::size_t start = 0; not *stop_token; ++start) {
+        if (worker == 0 && start == 0) {
+            randomised_greedy(state, 0, rng);
+        } else if (incumbent.profit() > 0 && from_incumbent(rng)) {
+            incumbent.read(soln);
+            state.sync();
+            perturb(state, params.perturbation_strength, rng);
+        } else {
+            randomised_greedy(state, skip_probability(rng), rng);
+        }
+
+        stats += solution_hillclimb_improve(instance, soln, stop_token, no_callback, simple_params);
+        if (params.hillclimb.compound_moves && soln.p >= params.compound_threshold * incumbent.profit()) {
+            stats += solution_hillclimb_improve(instance, soln, stop_token, no_callback, params.hillclimb);
+        }
+
+        incumbent.publish(soln);
+    }
+
+    return stats;
+}
+
+HillclimbStats solve_dckp_hillclimb_mt(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const HillclimbMtParams& params) {
+    profiler::ScopedTicToc tictoc("solve_dckp_hillclimb_mt");
+
+    soln.p = 0;
+    soln.w = 0;
+    soln.x.reset();
+
+    SharedIncumbent incumbent(instance.num_items());
+
+    unsigned num_threads = params.num_threads > 0? params.num_threads : ThreadPool::hardware_threads();
+    std::vector<HillclimbStats> worker_stats(num_threads);
+
+    // Report the incumbent from this thread whenever it improves
+    auto report = [&]() {
+        if (incumbent.profit() > soln.p) {
+            incumbent.read(soln);
+            solution_callback(soln);
+        }
+    };
+
+    {
+        ThreadPool pool(num_threads);
+
+        std::vector<std::future<void>> futures;
+        for (unsigned k = 0; k < num_threads; ++k) {
+            futures.push_back(pool.submit([&, k]() {
+                worker_stats[k] = run_worker(instance, k, incumbent, stop_token, params);
+            }));
+        }
+
+        for (auto& future : futures) {
+            while (future.wait_for(std::chrono::milliseconds(5)) != std::future_status::ready) {
+                report();
+            }
+            future.get();
+        }
+    }
+
+    report();
+
+    if (soln.p == 0) {
+        solution_callback(soln);
+    }
+
+    HillclimbStats stats;
+    for (const auto& s : worker_stats) {
+        stats += s;
+    }
+    return stats;
+}
+
+} // namespace dckp_ienum
@@ -1,61 +1,42 @@
 #include "dckp_ienum/dckp_hillclimb_solver.hpp"
+#include "dckp_ienum/local_search_moves.hpp"
 #include "dckp_ienum/conflicts.hpp"
 #include "dckp_ienum/profiler.hpp"
 #include "dckp_ienum/solution_has_conflicts.hpp"
 #include "dckp_ienum/solution_sanity_check.hpp"
+#include "dckp_ienum/solution_state.hpp"
 #include "dckp_ienum/types.hpp"
 #include <dckp_ienum/instance.hpp>
 #include <dckp_ienum/solution_print.hpp>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <tuple>
 #include <variant>
 namespace dckp_ienum {
 
-class AddMove;
-class SwapMove;
-
-#define MOVE_LIST AddMove, SwapMove
+#define SIMPLE_MOVE_LIST AddMove, SwapMove
+#define COMPOUND_MOVE_LIST Drop1Add2Move, Drop2Add1Move, EjectionChainMove
+#define MOVE_LIST SIMPLE_MOVE_LIST, COMPOUND_MOVE_LIST
 using Move = std::variant<MOVE_LIST>;
 
-class AddMove {
-    item_index_t i;
-    
-public:
-    AddMove(item_index_t i) : i(i) {}
-
-    void apply(const Instance& instance, Solution& soln, HillclimbStats& stats) {
-        soln.p += instance.profit(i);
-        soln.w += instance.weight(i);
-        soln.x[i] = true;
-
-        ++stats.adds;
-    }
-};
-
-class SwapMove {
-    item_index_t i;
-    item_index_t j;
-
-public:
-    SwapMove(item_index_t i, item_index_t j) : i(i), j(j) {}
-
-    void apply(const Instance& instance, Solution& soln, HillclimbStats& stats) {
-        soln.p -= instance.profit(i);
-        soln.w -= instance.weight(i);
-
-        soln.p += instance.profit(j);
-        soln.w += instance.weight(j);
-
-        soln.x[i] = false;
-        soln.x[j] = true;
+// Only the first neighbours of an item (the ones with the best p/w ratio) are candidates for the compound moves
+static constexpr std::size_t CANDIDATE_NEIGHBOURS = 16;
 
-        ++stats.swaps;
-    }
-};
+static inline ConflictList candidate_neighbours(const Instance& instance, item_index_t i) {
+    // Conflict lists are sorted by index, i.e. by decreasing p/w ratio
+    ConflictList conflicts = instance.conflicts(i);
+    return ConflictList(conflicts.data(), std::min(conflicts.size(), CANDIDATE_NEIGHBOURS));
+}
 
 template <typename T>
-inline void generate_moves_impl(const Instance& instance, Solution& soln, const std::function<void (Move, int_profit_t)> &callback);
+inline void generate_moves_impl(const SolutionState& state, const std::function<void (Move, int_profit_t)> &callback);
 
 template <>
-inline void generate_moves_impl<AddMove>(const Instance& instance, Solution& soln, const std::function<void (Move, int_profit_t)> &callback) {
+inline void generate_moves_impl<AddMove>(const SolutionState& state, const std::function<void (Move, int_profit_t)> &callback) {
+    const Instance& instance = state.instance();
+    const Solution& soln = state.solution();
+
     for (item_index_t i = 0; i < instance.num_items(); ++i) {
         if (soln.x[i]) {
             continue;
@@ -71,24 +52,19 @@ inline void generate_moves_impl<AddMove>(const Instance& instance, Solution& sol
             continue;
         }
 
-        ConflictConstIterator conflicts_begin = find_conflict_iterator(instance.conflicts(), i);
-        ConflictConstIterator conflicts_end = instance.conflicts().end();
-        if (check_conflict(soln.x, i, conflicts_begin, conflicts_end)) {
+        if (state.blocked(i)) {
             continue;
         }
 
-        ConflictConstIterator rconflicts_begin = find_conflict_iterator(instance.rconflicts(), i);
-        ConflictConstIterator rconflicts_end = instance.rconflicts().end();
-        if (check_conflict(soln.x, i, rconflicts_begin, rconflicts_end)) {
-            continue;
-        }
-        
         callback(AddMove { i }, p);
     }
 }
 
 template <>
-void generate_moves_impl<SwapMove>(const Instance &instance, Solution &soln, const std::function<void (Move, int_profit_t)> &callback) {
+void generate_moves_impl<SwapMove>(const SolutionState &state, const std::function<void (Move, int_profit_t)> &callback) {
+    const Instance& instance = state.instance();
+    const Solution& soln = state.solution();
+
     for (item_index_t i = 0; i < instance.num_items(); ++i) {
         if (not soln.x[i]) {
             continue;
@@ -112,49 +88,428 @@ void generate_moves_impl<SwapMove>(const Instance &instance, Solution &soln, con
                 continue;
             }
 
-            soln.x[i] = false;
+            // j must not conflict with any item in the knapsack but i
+            if (state.blocked_by(j) > item_index_t(items_conflict(instance, i, j))) {
+                continue;
+            }
+
+            callback(SwapMove { i, j }, p);
+        }
+    }
+}
+
+// Drop i, add two items freed by dropping it (its candidate neighbours blocked only by i) or among the best free items
+template <>
+void generate_moves_impl<Drop1Add2Move>(const SolutionState &state, const std::function<void (Move, int_profit_t)> &callback) {
+    const Instance& instance = state.instance();
+    const Solution& soln = state.solution();
+    const int_weight_t slack = instance.capacity() - soln.w;
+
+    std::vector<item_index_t> free_items;
+    for (item_index_t j = 0; j < instance.num_items() && free_items.size() < CANDIDATE_NEIGHBOURS; ++j) {
+        if (not soln.x[j] && not state.blocked(j)) {
+            free_items.push_back(j);
+        }
+    }
+
+    // The pairs of free items do not depend on the item dropped: keep the compatible ones by increasing weight,
+    // with the most profitable pair up to each, so that the best one within the room left by i is found by binary search
+    struct Pair {
+        int_profit_t profit;
+        int_weight_t weight;
+        item_index_t j;
+        item_index_t k;
+    };
+    std::vector<Pair> free_pairs;
+    for (std::size_t a = 0; a < free_items.size(); ++a) {
+        for (std::size_t b = a + 1; b < free_items.size(); ++b) {
+            const item_index_t j = free_items[a];
+            const item_index_t k = free_items[b];
+            if (not items_conflict(instance, j, k)) {
+                free_pairs.push_back({ instance.profit(j) + instance.profit(k), instance.weight(j) + instance.weight(k), j, k });
+            }
+        }
+    }
+    std::stable_sort(free_pairs.begin(), free_pairs.end(), [](const Pair& a, const Pair& b) {
+        return a.weight < b.weight;
+    });
+    std::vector<std::size_t> best_pair(free_pairs.size());
+    for (std::size_t k = 0; k < free_pairs.size(); ++k) {
+        best_pair[k] = k > 0 && free_pairs[best_pair[k - 1]].profit >= free_pairs[k].profit? best_pair[k - 1] : k;
+    }
+
+    std::vector<item_index_t> tight;
+    soln.x.for_each([&](item_index_t i) {
+        const int_weight_t room = slack + instance.weight(i);
+
+        auto consider = [&](item_index_t j, item_index_t k) {
+            if (instance.weight(j) + instance.weight(k) > room) {
+                return;
+            }
+
+            int_profit_t p = soln.p - instance.profit(i) + instance.profit(j) + instance.profit(k);
+            if (p <= soln.p || p > soln.ub) {
+                return;
+            }
+
+            if (items_conflict(instance, j, k)) {
+                return;
+            }
+
+            callback(Drop1Add2Move { { i }, { j, k } }, p);
+        };
+
+        // Of the pairs of free items, only the most profitable one that fits can make the best move
+        auto fits = std::upper_bound(free_pairs.begin(), free_pairs.end(), room, [](int_weight_t w, const Pair& pair) { return w < pair.weight; });
+        if (fits != free_pairs.begin()) {
+            const Pair& pair = free_pairs[best_pair[fits - free_pairs.begin() - 1]];
+            const int_profit_t p = soln.p - instance.profit(i) + pair.profit;
+            if (p > soln.p && p <= soln.ub) {
+                callback(Drop1Add2Move { { i }, { pair.j, pair.k } }, p);
+            }
+        }
+
+        // The neighbours freed by dropping i, with each other or with a free item
+        tight.clear();
+        for (item_index_t j : candidate_neighbours(instance, i)) {
+            if (not soln.x[j] && state.blocked_by(j) == 1) {
+                tight.push_back(j);
+            }
+        }
+        for (std::size_t a = 0; a < tight.size(); ++a) {
+            for (std::size_t b = a + 1; b < tight.size(); ++b) {
+                consider(tight[a], tight[b]);
+            }
+            for (item_index_t k : free_items) {
+                consider(tight[a], k);
+            }
+        }
+    });
+}
+
+// Drop the two blockers of a candidate neighbour j, or its only blocker and the cheapest item that makes room for it
+template <>
+void generate_moves_impl<Drop2Add1Move>(const SolutionState &state, const std::function<void (Move, int_profit_t)> &callback) {
+    const Instance& instance = state.instance();
+    const Solution& soln = state.solution();
+    const int_weight_t slack = instance.capacity() - soln.w;
+
+    // The selected items by increasing weight, and the two least profitable ones from each position on,
+    // so that the cheapest item that makes room for j is found by binary search
+    std::vector<item_index_t> selected;
+    soln.x.for_each([&](item_index_t i) { selected.push_back(i); });
+    std::sort(selected.begin(), selected.end(), [&](item_index_t a, item_index_t b) {
+        return std::make_pair(instance.weight(a), a) < std::make_pair(instance.weight(b), b);
+    });
+
+    auto profit_lt = [&](item_index_t a, item_index_t b) {
+        return std::make_pair(instance.profit(a), a) < std::make_pair(instance.profit(b), b);
+    };
+    std::vector<std::array<item_index_t, 2>> cheapest(selected.size() + 1, { invalid_v<item_index_t>, invalid_v<item_index_t> });
+    for (std::size_t k = selected.size(); k-- > 0; ) {
+        const item_index_t c = selected[k];
+        auto [first, second] = cheapest[k + 1];
+        if (first == invalid_v<item_index_t> || profit_lt(c, first)) {
+            cheapest[k] = { c, first };
+        } else if (second == invalid_v<item_index_t> || profit_lt(c, second)) {
+            cheapest[k] = { first, c };
+        } else {
+            cheapest[k] = { first, second };
+        }
+    }
+
+    soln.x.for_each([&](item_index_t i) {
+        for (item_index_t j : candidate_neighbours(instance, i)) {
+            // Whatever l is, dropping it too leaves j worth no more than i
+            if (soln.x[j] || instance.profit(j) <= instance.profit(i)) {
+                continue;
+            }
+
+            item_index_t l = invalid_v<item_index_t>;
+            if (state.blocked_by(j) == 2) {
+                // The XOR of the blockers only names the other one if the two are distinct
+                l = state.blocker(j) ^ i;
+                if (l == i || instance.weight(j) > slack + instance.weight(i) + instance.weight(l)) {
+                    continue;
+                }
+            } else if (state.blocked_by(j) == 1 && instance.weight(j) > slack + instance.weight(i)) {
+                const int_weight_t needed = instance.weight(j) - slack - instance.weight(i);
+                auto it = std::lower_bound(selected.begin(), selected.end(), needed, [&](item_index_t a, int_weight_t w) { return instance.weight(a) < w; });
+                const auto& [first, second] = cheapest[it - selected.begin()];
+                l = first != i? first : second;
+            }
 
-            ConflictConstIterator conflicts_begin = find_conflict_iterator(instance.conflicts(), j);
-            ConflictConstIterator conflicts_end = instance.conflicts().end();
-            if (check_conflict(soln.x, j, conflicts_begin, conflicts_end)) {
-                soln.x[i] = true;
+            if (l == invalid_v<item_index_t>) {
                 continue;
             }
 
-            ConflictConstIterator rconflicts_begin = find_conflict_iterator(instance.rconflicts(), j);
-            ConflictConstIterator rconflicts_end = instance.rconflicts().end();
-            if (check_conflict(soln.x, j, rconflicts_begin, rconflicts_end)) {
-                soln.x[i] = true;
+            int_profit_t p = soln.p - instance.profit(i) - instance.profit(l) + instance.profit(j);
+            if (p <= soln.p || p > soln.ub) {
                 continue;
             }
 
-            soln.x[i] = true;
-            callback(SwapMove { i, j }, p);
+            callback(Drop2Add1Move { { i, l }, { j } }, p);
         }
-    }
+    });
+}
+
+// j enters ejecting its only blocker i, then k (also a neighbour of i) enters ejecting its other blocker l
+template <>
+void generate_moves_impl<EjectionChainMove>(const SolutionState &state, const std::function<void (Move, int_profit_t)> &callback) {
+    const Instance& instance = state.instance();
+    const Solution& soln = state.solution();
+    const int_weight_t slack = instance.capacity() - soln.w;
+
+    soln.x.for_each([&](item_index_t i) {
+        const ConflictList candidates = candidate_neighbours(instance, i);
+
+        for (item_index_t j : candidates) {
+            if (soln.x[j] || state.blocked_by(j) != 1) {
+                continue;
+            }
+
+            for (item_index_t k : candidates) {
+                if (soln.x[k] || state.blocked_by(k) != 2) {
+                    continue;
+                }
+                const item_index_t l = state.blocker(k) ^ i;
+                if (l == i) {
+                    continue;
+                }
+
+                if (instance.weight(j) + instance.weight(k) > slack + instance.weight(i) + instance.weight(l)) {
+                    continue;
+                }
+
+                int_profit_t p = soln.p - instance.profit(i) - instance.profit(l) + instance.profit(j) + instance.profit(k);
+                if (p <= soln.p || p > soln.ub) {
+                    continue;
+                }
+
+                // l cannot conflict with j, whose only blocker is i
+                if (items_conflict(instance, j, k)) {
+                    continue;
+                }
+
+                callback(EjectionChainMove { { i, l }, { j, k } }, p);
+            }
+        }
+    });
 }
 
 template <typename... Moves>
-static inline void generate_moves_impl_(const Instance &instance, Solution &soln, const std::function<void (Move, int_profit_t)> &callback) {
-    (generate_moves_impl<Moves>(instance, soln, callback), ...);
+static inline void generate_moves_impl_(const SolutionState &state, const std::function<void (Move, int_profit_t)> &callback) {
+    (generate_moves_impl<Moves>(state, callback), ...);
 }
 
-static inline void generate_moves(const Instance &instance, Solution &soln, const std::function<void (Move, int_profit_t)> &callback) {
-    generate_moves_impl_<MOVE_LIST>(instance, soln, callback);
+static inline void generate_moves(const SolutionState &state, const std::function<void (Move, int_profit_t)> &callback) {
+    generate_moves_impl_<SIMPLE_MOVE_LIST>(state, callback);
 }
 
+static inline void generate_compound_moves(const SolutionState &state, const std::function<void (Move, int_profit_t)> &callback) {
+    generate_moves_impl_<COMPOUND_MOVE_LIST>(state, callback);
+}
 
-HillclimbStats solve_dckp_hillclimb(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback) {
-    profiler::ScopedTicToc tictoc("solve_dckp_hillclimb");
 
+// Set of items with O(1) insertion, removal and lookup
+class IndexedItemSet {
+    std::vector<item_index_t> m_items;
+    std::vector<item_index_t> m_positions;
+
+public:
+    explicit IndexedItemSet(item_index_t n) : m_positions(n, invalid_v<item_index_t>) {}
+
+    bool contains(item_index_t i) const { return m_positions[i] != invalid_v<item_index_t>; }
+
+    void insert(item_index_t i) {
+        if (contains(i)) {
+            return;
+        }
+        m_positions[i] = m_items.size();
+        m_items.push_back(i);
+    }
+
+    void erase(item_index_t i) {
+        if (not contains(i)) {
+            return;
+        }
+        item_index_t last = m_items.back();
+        m_items[m_positions[i]] = last;
+        m_positions[last] = m_positions[i];
+        m_items.pop_back();
+        m_positions[i] = invalid_v<item_index_t>;
+    }
+
+    auto begin() const { return m_items.begin(); }
+    auto end() const { return m_items.end(); }
+};
+
+/*
+Finds the same best move as generate_moves, without enumerating the whole neighbourhood.
+
+The items out of the knapsack that could enter it are kept between iterations, split by the number of selected items
+they conflict with: "free" items can be added or swapped with any selected item, while "tight" items can only be
+swapped with their only blocker. After a move, only the moved items and their neighbours are reclassified.
+The selected items are kept sorted by weight, so the cheapest item to swap out to make room for a free item
+that does not fit the capacity slack is found by binary search.
+*/
+class MoveEvaluator {
+    SolutionState& m_state;
+    IndexedItemSet m_free;
+    IndexedItemSet m_tight;
+    std::vector<item_index_t> m_selected;   // by increasing weight
+    std::vector<item_index_t> m_cheapest;   // m_cheapest[k] = least profitable item in m_selected[k..]
+
+    const Instance& instance() const { return m_state.instance(); }
+
+    bool weight_lt(item_index_t a, item_index_t b) const {
+        return std::make_pair(instance().weight(a), a) < std::make_pair(instance().weight(b), b);
+    }
+
+    void refresh(item_index_t i) {
+        if (m_state.solution().x[i] || m_state.blocked_by(i) > 1) {
+            m_free.erase(i);
+            m_tight.erase(i);
+        } else if (m_state.blocked(i)) {
+            m_free.erase(i);
+            m_tight.insert(i);
+        } else {
+            m_tight.erase(i);
+            m_free.insert(i);
+        }
+    }
+
+    void select(item_index_t i) {
+        auto it = std::lower_bound(m_selected.begin(), m_selected.end(), i, [&](item_index_t a, item_index_t b) { return weight_lt(a, b); });
+        m_selected.insert(it, i);
+    }
+
+    void deselect(item_index_t i) {
+        auto it = std::lower_bound(m_selected.begin(), m_selected.end(), i, [&](item_index_t a, item_index_t b) { return weight_lt(a, b); });
+        m_selected.erase(it);
+    }
+
+    void update_cheapest() {
+        const Instance& instance = this->instance();
+        m_cheapest.resize(m_selected.size());
+        for (std::size_t k = m_selected.size(); k-- > 0; ) {
+            item_index_t i = m_selected[k];
+            if (k + 1 < m_selected.size()) {
+                item_index_t c = m_cheapest[k + 1];
+                if (std::make_pair(instance.profit(c), c) < std::make_pair(instance.profit(i), i)) {
+                    i = c;
+                }
+            }
+            m_cheapest[k] = i;
+        }
+    }
+
+public:
+    explicit MoveEvaluator(SolutionState& state) :
+        m_state(state),
+        m_free(state.instance().num_items()),
+        m_tight(state.instance().num_items())
+    {
+        for (item_index_t i = 0; i < instance().num_items(); ++i) {
+            refresh(i);
+        }
+        state.solution().x.for_each([&](item_index_t i) { select(i); });
+    }
+
+    // Same choice as the best-improvement loop over generate_moves: highest profit, then first in enumeration order
+    std::optional<Move> best_move() {
+        const Instance& instance = this->instance();
+        const Solution& soln = m_state.solution();
+        const int_weight_t slack = instance.capacity() - soln.w;
+
+        // (profit, kind, i, j): a move wins with higher profit, then with lower (kind, i, j). Adds are kind 0.
+        std::tuple<int_profit_t, int, item_index_t, item_index_t> best { soln.p, 0, 0, 0 };
+        bool found = false;
+        auto consider = [&](int_profit_t p, int kind, item_index_t i, item_index_t j) {
+            auto [best_p, best_kind, best_i, best_j] = best;
+            if (p > best_p || (found && p == best_p && std::make_tuple(kind, i, j) < std::make_tuple(best_kind, best_i, best_j))) {
+                best = { p, kind, i, j };
+                found = true;
+            }
+        };
+
+        update_cheapest();
+
+        for (item_index_t j : m_free) {
+            if (instance.weight(j) <= slack) {
+                consider(soln.p + instance.profit(j), 0, j, 0);
+            } else {
+                // Swapping j in for anything lighter than this cannot fit. If j fits, adding it beats any swap.
+                const int_weight_t needed = instance.weight(j) - slack;
+                auto it = std::lower_bound(m_selected.begin(), m_selected.end(), needed, [&](item_index_t a, int_weight_t w) { return instance.weight(a) < w; });
+                if (it != m_selected.end()) {
+                    item_index_t i = m_cheapest[it - m_selected.begin()];
+                    consider(soln.p - instance.profit(i) + instance.profit(j), 1, i, j);
+                }
+            }
+        }
+
+        for (item_index_t j : m_tight) {
+            item_index_t i = m_state.blocker(j);
+            if (instance.weight(j) <= slack + instance.weight(i)) {
+                consider(soln.p - instance.profit(i) + instance.profit(j), 1, i, j);
+            }
+        }
+
+        if (not found) {
+            return std::nullopt;
+        }
+
+        auto [p, kind, i, j] = best;
+        if (kind == 0) {
+            return AddMove { i };
+        }
+        return SwapMove { i, j };
+    }
+
+    void apply(const Move& move, HillclimbStats& stats) {
+        std::visit([&](auto& arg) {
+            const Solution& soln = m_state.solution();
+            arg.for_each_item([&](item_index_t i) {
+                if (soln.x[i]) {
+                    deselect(i);
+                }
+            });
+
+            arg.apply(m_state, stats);
+
+            arg.for_each_item([&](item_index_t i) {
+                if (soln.x[i]) {
+                    select(i);
+                }
+                refresh(i);
+                for (item_index_t j : instance().conflicts(i)) {
+                    refresh(j);
+                }
+            });
+        }, move);
+    }
+};
+
+HillclimbStats solution_hillclimb_improve(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const HillclimbParams& params) {
     HillclimbStats stats;
 
     int_profit_t best_profit;
     std::optional<Move> best_move;
 
-    soln.p = 0;
-    soln.w = 0;
-    std::fill(soln.x.begin(), soln.x.end(), false);
+    SolutionState state(instance, soln);
+
+    std::optional<MoveEvaluator> evaluator;
+    if (params.neighbourhood == HillclimbNeighbourhood::Incremental) {
+        evaluator.emplace(state);
+    }
+
+    auto consider = [&](Move move, int_profit_t profit) {
+        if (profit > best_profit) {
+            best_move = move;
+            best_profit = profit;
+        }
+    };
 
     do {
         if (*stop_token) {
@@ -164,22 +519,41 @@ HillclimbStats solve_dckp_hillclimb(const dckp_ienum::Instance& instance, Soluti
         best_move.reset();
         best_profit = soln.p;
 
-        generate_moves(instance, soln, [&](Move move, int_profit_t profit) {
-            if (profit > best_profit) {
-                best_move = move;
-                best_profit = profit;
-            }
-        });
+        if (evaluator) {
+            best_move = evaluator->best_move();
+        } else {
+            generate_moves(state, consider);
+        }
+
+        // Local optimum of the simple moves
+        if (not best_move.has_value() && params.compound_moves) {
+            generate_compound_moves(state, consider);
+        }
 
         if (best_move.has_value()) {
-            std::visit([&](auto& arg) {
-                arg.apply(instance, soln, stats);
-            }, *best_move);
+            if (evaluator) {
+                evaluator->apply(*best_move, stats);
+            } else {
+                std::visit([&](auto& arg) {
+                    arg.apply(state, stats);
+                }, *best_move);
+            }
 
             solution_callback(soln);
         }
     } while(best_move.has_value());
 
+    return stats;
+}
+
+HillclimbStats solve_dckp_hillclimb(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const HillclimbParams& params) {
+    profiler::ScopedTicToc tictoc("solve_dckp_hillclimb");
+
+    soln.p = 0;
+    soln.w = 0;
+    soln.x.reset();
+
+    HillclimbStats stats = solution_hillclimb_improve(instance, soln, stop_token, solution_callback, params);
 
     if (soln.p == 0) {
         solution_callback(soln);
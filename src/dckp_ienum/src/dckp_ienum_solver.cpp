@@ -2,8 +2,10 @@
 #include "dckp_ienum/profiler.hpp"
 #include <algorithm>
 #include <initializer_list>
+#include <stdexcept>
 
 #include <dckp_ienum/solution_has_conflicts.hpp>
+#include <dckp_ienum/clique_fkp_solver.hpp>
 #include <dckp_ienum/fkp_solver.hpp>
 #include <dckp_ienum/dckp_ienum_solver.hpp>
 #include <dckp_ienum/ldckp_solver.hpp>
@@ -16,18 +18,22 @@ namespace dckp_ienum {
 using ItemSet = std::vector<item_index_t>;
 
 struct IEnumNode {
-    std::vector<bool> x;
+    Bitset x;
     ItemSet conflict_set;
     int_profit_t profit = 0;
     int_weight_t weight = 0;
     int_profit_t ub = std::numeric_limits<int_profit_t>::max();
 
+    // Critical item of the FKP bound (see FkpResult::fractional_idx), the starting point of the bounds of the children
+    item_index_t fkp_critical = invalid_v<item_index_t>;
+
     IEnumNode() {}
 
-    IEnumNode(const IEnumNode& parent, item_index_t j, int_profit_t profit, int_weight_t weight, const ItemSet& jth_conflict_set, int_profit_t ub)
+    IEnumNode(const IEnumNode& parent, item_index_t j, int_profit_t profit, int_weight_t weight, const ItemSet& jth_conflict_set, int_profit_t ub, item_index_t fkp_critical)
         : profit(profit),
           weight(weight),
-          ub(ub)
+          ub(ub),
+          fkp_critical(fkp_critical)
     {
         // Extend solution
         x.reserve(j + 1);
@@ -49,9 +55,23 @@ struct IEnumNode {
     }
 };
 
-void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback) {
+void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, UpperBound bound, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback) {
     profiler::ScopedTicToc ticto("solve_dckp_ienum");
 
+    if (bound != UpperBound::Fkp && bound != UpperBound::CliqueFkp) {
+        throw std::invalid_argument("ienum only supports the Fkp and CliqueFkp bounds");
+    }
+
+    // The multiple-choice bound needs the items fixed by the node, not only their profit and weight
+    CliquePartition partition;
+    CliqueFkpWorkspace clique_fkp_workspace;
+    CliqueFkpResult clique_fkp_result;
+    Bitset fixed_items;
+    if (bound == UpperBound::CliqueFkp) {
+        partition = CliquePartition(instance);
+        fixed_items.resize(instance.num_items());
+    }
+
     std::vector<IEnumNode> next_fifo;
     std::vector<IEnumNode> current_fifo;
 
@@ -59,12 +79,6 @@ void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, std:
 
     // Push a node with no choices made
     current_fifo.emplace_back();
-    
-    auto jp1th_rconflicts_begin = instance.rconflicts().begin();
-    auto rconflicts_end = instance.rconflicts().end();
-
-    auto jth_conflicts_begin = instance.conflicts().begin();
-    auto conflicts_end = instance.conflicts().end();
 
     for (item_index_t j = 0; j < instance.num_items(); ++j) {
         std::cout << "level " << j << ", " << current_fifo.size() << " nodes" << std::endl;
@@ -84,20 +98,15 @@ void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, std:
             break;
         }
 
-        advance_conflict_iterator(j, jth_conflicts_begin, conflicts_end);
-        advance_conflict_iterator(j, jp1th_rconflicts_begin, rconflicts_end);
-
         /* Update jth_conflict_set with the items not yet in the knapsack that conflict with item j */
         {
             profiler::ScopedTicToc tictoc("jth_conflict_set");
             jth_conflict_set.clear();
 
-            for (auto conflict_it = jth_conflicts_begin; conflict_it != conflicts_end && conflict_it->i == j; ++conflict_it) {
-                item_index_t conflicting_item = conflict_it->j;
-
-                auto it = std::lower_bound(jth_conflict_set.begin(), jth_conflict_set.end(), conflicting_item);
-                if (it == jth_conflict_set.end() || *it != conflicting_item) {
-                    jth_conflict_set.insert(it, conflicting_item);
+            // The adjacency rows are sorted, so we only have to skip duplicates
+            for (item_index_t conflicting_item : instance.forward_conflicts(j)) {
+                if (jth_conflict_set.empty() || jth_conflict_set.back() != conflicting_item) {
+                    jth_conflict_set.push_back(conflicting_item);
                 }
             }
         }
@@ -128,7 +137,9 @@ void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, std:
                     }
     
                     auto& other_node = current_fifo[other_node_idx];
-                    if (other_node.profit >= parent.profit && other_node.weight <= parent.weight) {
+                    // Of two equivalent nodes only the later one is dominated, or both would be terminated
+                    const bool equivalent = other_node.profit == parent.profit && other_node.weight == parent.weight && other_node.conflict_set.size() == parent.conflict_set.size();
+                    if (other_node.profit >= parent.profit && other_node.weight <= parent.weight && (not equivalent || other_node_idx < parent_idx)) {
                         // Is the conflict set of the other node a subset of the current node?
                         dominated = std::includes(
                             parent.conflict_set.begin(), parent.conflict_set.end(),
@@ -149,8 +160,7 @@ void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, std:
             if (parent.profit > soln.p) {
                 soln.w = parent.weight;
                 soln.p = parent.profit;
-                soln.x = parent.x;
-                soln.x.resize(instance.num_items(), false);
+                soln.x.assign_prefix(parent.x, parent.x.size());
                 solution_callback(soln);
             }
 
@@ -176,20 +186,42 @@ void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, std:
                 add_true = true;
             } while (false);
 
-            // C4
-            int_profit_t ub_true = add_true? solve_fkp_fast(instance, j+1, p, w).ub : 0;
-            int_profit_t ub_false = solve_fkp_fast(instance, j+1, parent.profit, parent.weight).ub;
+            // C4. The bounds of the children only move the critical item of the parent by a few positions.
+            FkpResult fkp_true;
+            fkp_true.ub = 0;
+            fkp_true.fractional_idx = invalid_v<item_index_t>;
+            if (add_true) {
+                fkp_true = solve_fkp_fast(instance, j+1, p, w, parent.fkp_critical);
+            }
+            FkpResult fkp_false = solve_fkp_fast(instance, j+1, parent.profit, parent.weight, parent.fkp_critical);
+
+            if (bound == UpperBound::CliqueFkp) {
+                // Never looser than FKP, only computed for the children that FKP does not prune
+                // Nodes only store x up to the last item they took
+                fixed_items.assign_prefix(parent.x, parent.x.size());
+                if (add_true && fkp_true.ub >= soln.p) {
+                    fixed_items[j] = true;
+                    solve_clique_fkp(instance, partition, fixed_items, j+1, p, w, clique_fkp_workspace, clique_fkp_result);
+                    fkp_true.ub = clique_fkp_result.ub;
+                    fixed_items[j] = false;
+                }
+                if (fkp_false.ub >= soln.p) {
+                    solve_clique_fkp(instance, partition, fixed_items, j+1, parent.profit, parent.weight, clique_fkp_workspace, clique_fkp_result);
+                    fkp_false.ub = clique_fkp_result.ub;
+                }
+            }
 
             if (add_true) {
-                if (ub_true >= soln.p) {
+                if (fkp_true.ub >= soln.p) {
                     profiler::ScopedTicToc tictoc("create_true_node");
-                    next_fifo.emplace_back(parent, j, p, w, jth_conflict_set, ub_true);
+                    next_fifo.emplace_back(parent, j, p, w, jth_conflict_set, fkp_true.ub, fkp_true.fractional_idx);
                 }
             }
-            if (ub_false >= soln.p) {
+            if (fkp_false.ub >= soln.p) {
                 profiler::ScopedTicToc tictoc("create_false_node");
                 next_fifo.push_back(parent);
-                next_fifo.back().ub = ub_false;
+                next_fifo.back().ub = fkp_false.ub;
+                next_fifo.back().fkp_critical = fkp_false.fractional_idx;
             }
 
             if (next_fifo.size() > 1'000'000) {
@@ -212,8 +244,7 @@ void solve_dckp_ienum(const dckp_ienum::Instance& instance, Solution& soln, std:
             if (node.profit > soln.p) {
                 soln.w = node.weight;
                 soln.p = node.profit;
-                soln.x = node.x;
-                soln.x.resize(instance.num_items(), false);
+                soln.x.assign_prefix(node.x, node.x.size());
                 solution_callback(soln);
             }
         }
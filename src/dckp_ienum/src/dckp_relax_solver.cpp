@@ -1,6 +1,7 @@
 #include "dckp_ienum/profiler.hpp"
 #include <variant>
 
+#include <dckp_ienum/clique_fkp_solver.hpp>
 #include <dckp_ienum/conflicts.hpp>
 #include <dckp_ienum/dckp_relax_solver.hpp>
 #include <dckp_ienum/ldckp_solver.hpp>
@@ -9,11 +10,22 @@
 
 namespace dckp_ienum {
 
-void solve_dckp_relax(const Instance& instance, Solution& solution, bool use_ldckp, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback) {
+void solve_dckp_relax(const Instance& instance, Solution& solution, UpperBound bound, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback) {
     profiler::ScopedTicToc tictoc("solve_dckp_relax");
 
-    if (use_ldckp) {
-        auto result = dckp_ienum::solve_ldckp(instance, solution.x, 0, 0, 0, instance.rconflicts().begin(), dckp_ienum::LdckpSolverParams {});
+    if (bound == UpperBound::Ldckp || bound == UpperBound::LdckpCliques) {
+        LdckpSolverParams params;
+        CliqueCover cliques;
+        if (bound == UpperBound::LdckpCliques) {
+            cliques = CliqueCover(instance);
+            params.cliques = &cliques;
+        }
+        auto result = dckp_ienum::solve_ldckp(instance, solution.x, 0, 0, 0, params);
+        result.convert(instance, solution, 0);
+    } else if (bound == UpperBound::CliqueFkp) {
+        CliqueFkpWorkspace workspace;
+        CliqueFkpResult result;
+        solve_clique_fkp(instance, CliquePartition(instance), solution.x, 0, 0, 0, workspace, result);
         result.convert(instance, solution, 0);
     } else {
         auto result = solve_fkp_fast(instance, 0, 0, 0);
@@ -23,20 +35,19 @@ void solve_dckp_relax(const Instance& instance, Solution& solution, bool use_ldc
     if (*stop_token) {
         solution.p = 0;
         solution.w = 0;
-        std::fill(solution.x.begin(), solution.x.end(), false);
+        solution.x.reset();
         solution_callback(solution);
         return;
     }
 
-    solution_greedy_remove_conflicts(instance, solution, 0, instance.rconflicts().begin());
+    solution_greedy_remove_conflicts(instance, solution, 0);
 
     if (*stop_token) {
         solution_callback(solution);
         return;
     }
 
-    auto rconflicts_it = instance.rconflicts().begin();
-    solution_greedy_improve(instance, solution, 0, rconflicts_it, instance.conflicts().begin());
+    solution_greedy_improve(instance, solution, 0);
 
     solution_callback(solution);
 }
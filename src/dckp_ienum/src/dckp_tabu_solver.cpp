@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <variant>
+#include <vector>
+
+#include <dckp_ienum/dckp_tabu_solver.hpp>
+#include <dckp_ienum/local_search_moves.hpp>
+#include <dckp_ienum/profiler.hpp>
+#include <dckp_ienum/solution_state.hpp>
+
+namespace dckp_ienum {
+
+using TabuMove = std::variant<AddMove, SwapMove, DropMove>;
+
+class TabuSearch {
+    const Instance& m_instance;
+    const TabuParams& m_params;
+
+    Solution m_current;
+    SolutionState m_state;
+
+    std::vector<std::size_t> m_tabu_until;  // iteration from which each item can be moved again
+    std::vector<item_index_t> m_selected;   // by increasing profit, rebuilt at each iteration
+    std::size_t m_iteration = 0;
+    std::mt19937_64 m_rng;
+
+    bool is_tabu(item_index_t i) const { return m_tabu_until[i] > m_iteration; }
+
+    void make_tabu(item_index_t i) {
+        std::size_t tenure = m_params.min_tenure;
+        if (m_params.tenure_range > 0) {
+            tenure += m_rng() % m_params.tenure_range;
+        }
+        m_tabu_until[i] = m_iteration + tenure;
+    }
+
+    void collect_selected() {
+        m_selected.clear();
+        m_current.x.for_each([&](item_index_t i) { m_selected.push_back(i); });
+        std::sort(m_selected.begin(), m_selected.end(), [&](item_index_t a, item_index_t b) {
+            return m_instance.profit(a) < m_instance.profit(b);
+        });
+    }
+
+public:
+    TabuSearch(const Instance& instance, const TabuParams& params) :
+        m_instance(instance),
+        m_params(params),
+        m_state(instance, m_current),
+        m_tabu_until(instance.num_items(), 0),
+        m_rng(params.seed)
+    {
+        m_current.x.resize(instance.num_items());
+
+        // Start from the greedy solution
+        for (item_index_t i = 0; i < instance.num_items(); ++i) {
+            if (m_state.can_add(i)) {
+                m_state.add(i);
+            }
+        }
+    }
+
+    const Solution& current() const { return m_current; }
+
+    /*
+    Best admissible move: a move is admissible when none of its items is tabu, or when it improves on best_p (aspiration).
+    Unlike hillclimb, the best admissible move is taken even when it worsens the current solution.
+    */
+    std::optional<TabuMove> best_move(int_profit_t best_p) {
+        const Instance& instance = m_instance;
+        const int_profit_t p = m_current.p;
+        const int_weight_t slack = instance.capacity() - m_current.w;
+
+        std::optional<TabuMove> best;
+        int_profit_t best_move_p = 0;
+        auto consider = [&](int_profit_t move_p, bool tabu, TabuMove move) {
+            if (tabu && move_p <= best_p) {
+                return;
+            }
+            if (not best || move_p > best_move_p) {
+                best = move;
+                best_move_p = move_p;
+            }
+        };
+
+        collect_selected();
+
+        for (item_index_t j = 0; j < instance.num_items(); ++j) {
+            if (m_current.x[j]) {
+                continue;
+            }
+
+            const item_index_t blocked_by = m_state.blocked_by(j);
+            if (blocked_by == 0 && instance.weight(j) <= slack) {
+                consider(p + instance.profit(j), is_tabu(j), AddMove { j });
+            } else if (blocked_by == 0) {
+                // Swap out the least profitable admissible item that makes room for j
+                const int_weight_t needed = instance.weight(j) - slack;
+                for (item_index_t i : m_selected) {
+                    if (instance.weight(i) < needed) {
+                        continue;
+                    }
+                    const int_profit_t move_p = p - instance.profit(i) + instance.profit(j);
+                    if ((is_tabu(i) || is_tabu(j)) && move_p <= best_p) {
+                        continue;
+                    }
+                    consider(move_p, false, SwapMove { i, j });
+                    break;
+                }
+            } else if (blocked_by == 1) {
+                const item_index_t i = m_state.blocker(j);
+                if (instance.weight(j) <= slack + instance.weight(i)) {
+                    consider(p - instance.profit(i) + instance.profit(j), is_tabu(i) || is_tabu(j), SwapMove { i, j });
+                }
+            }
+        }
+
+        for (item_index_t i : m_selected) {
+            if (not is_tabu(i)) {
+                consider(p - instance.profit(i), false, DropMove { i });
+                break;
+            }
+        }
+
+        return best;
+    }
+
+    void apply(const TabuMove& move, HillclimbStats& stats) {
+        std::visit([&](auto& arg) {
+            arg.apply(m_state, stats);
+            arg.for_each_item([&](item_index_t i) { make_tabu(i); });
+        }, move);
+        ++m_iteration;
+    }
+
+    void skip_iteration() {
+        ++m_iteration;
+    }
+
+    // Drop a random subset of the selected items, which then stay out for a tenure
+    void perturb(HillclimbStats& stats) {
+        collect_selected();
+        if (m_selected.empty()) {
+            return;
+        }
+
+        std::size_t count = std::max<std::size_t>(1, m_params.perturbation_strength * m_selected.size());
+        std::shuffle(m_selected.begin(), m_selected.end(), m_rng);
+        for (std::size_t k = 0; k < count; ++k) {
+            DropMove { m_selected[k] }.apply(m_state, stats);
+            make_tabu(m_selected[k]);
+        }
+    }
+
+    void restart_from(const Solution& soln) {
+        m_current.p = soln.p;
+        m_current.w = soln.w;
+        m_current.x = soln.x;
+        m_state.sync();
+    }
+};
+
+HillclimbStats solve_dckp_tabu(const dckp_ienum::Instance& instance, Solution& soln, std::atomic<bool>* stop_token, const std::function<void(const Solution&)>& solution_callback, const TabuParams& params) {
+    profiler::ScopedTicToc tictoc("solve_dckp_tabu");
+
+    HillclimbStats stats;
+
+    soln.p = 0;
+    soln.w = 0;
+    soln.x.reset();
+
+    TabuSearch search(instance, params);
+
+    std::size_t stall = 0;
+    std::size_t perturbations = 0;
+
+    auto update_best = [&]() {
+        const Solution& current = search.current();
+        if (current.p > soln.p) {
+            soln.p = current.p;
+            soln.w = current.w;
+            soln.x = current.x;
+            solution_callback(soln);
+            stall = 0;
+        }
+    };
+
+    update_best();
+
+    while (not *stop_token) {
+        if (auto move = search.best_move(soln.p)) {
+            search.apply(*move, stats);
+        } else {
+            search.skip_iteration();
+        }
+
+        ++stall;
+        update_best();
+
+        if (stall >= params.max_stall) {
+            ++perturbations;
+            if (params.restart_every > 0 && perturbations % params.restart_every == 0) {
+                search.restart_from(soln);
+            }
+            search.perturb(stats);
+            stall = 0;
+        }
+    }
+
+    if (soln.p == 0) {
+        solution_callback(soln);
+    }
+
+    return stats;
+}
+
+} // namespace dckp_ienum
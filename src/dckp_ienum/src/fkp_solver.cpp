@@ -14,51 +14,99 @@ void FkpResult::convert(const Instance&, Solution &soln, item_index_t jp1) {
     soln.w = weight;
     soln.ub = ub; // std::min(ub, soln.ub);
 
-    for (item_index_t i = jp1; i < fractional_idx; ++i) {
-        soln.x[i] = true;
+    soln.x.set_range(jp1, fractional_idx);
+    soln.x.reset_range(fractional_idx, soln.x.size());
+}
+
+// First index in [begin, end) where pred holds (end if none), pred being false then true over the range
+template <typename Pred>
+static item_index_t first_true(item_index_t begin, item_index_t end, Pred pred) {
+    while (begin < end) {
+        item_index_t mid = begin + (end - begin) / 2;
+        if (pred(mid)) {
+            end = mid;
+        } else {
+            begin = mid + 1;
+        }
+    }
+    return begin;
+}
+
+// Same as first_true, galloping from hint: O(log d) where d is the distance between the hint and the result
+template <typename Pred>
+static item_index_t first_true_from(item_index_t begin, item_index_t end, item_index_t hint, Pred pred) {
+    if (hint < begin || hint > end) {
+        return first_true(begin, end, pred);
     }
-    for (item_index_t i = fractional_idx; i < soln.x.size(); ++i) {
-        soln.x[i] = false;
+
+    item_index_t step = 1;
+    if (hint == end || pred(hint)) {
+        // The result is in [begin, hint]
+        item_index_t upper = hint;
+        while (upper - begin >= step) {
+            item_index_t probe = upper - step;
+            if (not pred(probe)) {
+                return first_true(probe + 1, upper, pred);
+            }
+            upper = probe;
+            step *= 2;
+        }
+        return first_true(begin, upper, pred);
+    } else {
+        // The result is in (hint, end]
+        item_index_t lower = hint + 1;
+        while (end - lower > step) {
+            item_index_t probe = lower + step;
+            if (pred(probe)) {
+                return first_true(lower, probe, pred);
+            }
+            lower = probe + 1;
+            step *= 2;
+        }
+        return first_true(lower, end, pred);
     }
 }
 
-FkpResult solve_fkp_fast(const Instance& instance, item_index_t jp1, int_profit_t fixed_p, int_weight_t fixed_w) {
+FkpResult solve_fkp_fast(const Instance& instance, item_index_t jp1, int_profit_t fixed_p, int_weight_t fixed_w, item_index_t hint) {
     profiler::ScopedTicToc tictoc("solve_fkp_fast");
 
-    FkpResult ans;
-    ans.weight = fixed_w;
-    ans.profit = fixed_p;
-    ans.fractional_idx = instance.num_items();
-
-    for (item_index_t i = jp1; i < instance.num_items(); ++i) {
-        if (ans.weight >= instance.capacity()) {
-            ans.fractional_idx = i;
-            break;
-        }
+    const item_index_t n = instance.num_items();
+    const weight_sum_t* weight_prefix = instance.weight_prefix().data();
 
-        int_profit_t p = instance.profit(i);
-        if (p <= 0) {
-            ans.fractional_idx = i;
-            break;
-        }
-        
-        int_weight_t w = instance.weight(i);
-        int_weight_t new_w = ans.weight + w;
+    // The greedy fill from jp1 stops at the first item that does not fit entirely, or as soon as the knapsack is full
+    item_index_t critical = jp1;
+    if (fixed_w < instance.capacity()) {
+        // Value of the weight prefix sum at which the knapsack is full
+        const weight_sum_t full = instance.capacity() - fixed_w + weight_prefix[jp1];
 
-        if (new_w <= instance.capacity()) {
-            ans.profit += p;
-            ans.weight = new_w;
-        } else {
-            // Set the UB to the FKP profit
-            float_t fraction = static_cast<float_t>(instance.capacity() - ans.weight) / static_cast<float_t>(w);
-            ans.ub = ans.profit + static_cast<int_profit_t>(fraction * static_cast<float_t>(p));
-            ans.fractional_idx = i;
-            return ans;
+        critical = first_true_from(jp1, n, hint, [&](item_index_t i) { return weight_prefix[i + 1] > full; });
+        if (weight_prefix[critical] == full) {
+            critical = first_true(jp1, critical, [&](item_index_t i) { return weight_prefix[i] >= full; });
         }
     }
 
+    // It also stops at the first item without profit. Items are sorted by p/w, so those are all at the end.
+    item_index_t stop = critical < n? critical + 1 : n;
+    if (stop > jp1 && instance.profit(stop - 1) == 0) {
+        critical = first_true(jp1, stop, [&](item_index_t i) { return instance.profit(i) == 0; });
+        stop = critical;
+    }
+
+    FkpResult ans;
+    ans.fractional_idx = critical;
+    ans.profit = fixed_p + static_cast<int_profit_t>(instance.profit_sum(jp1, critical));
+    ans.weight = fixed_w + static_cast<int_weight_t>(instance.weight_sum(jp1, critical));
     ans.ub = ans.profit;
+
+    if (stop == critical + 1 && ans.weight < instance.capacity()) {
+        // Set the UB to the FKP profit
+        int_profit_t p = instance.profit(critical);
+        int_weight_t w = instance.weight(critical);
+        float_t fraction = static_cast<float_t>(instance.capacity() - ans.weight) / static_cast<float_t>(w);
+        ans.ub = ans.profit + static_cast<int_profit_t>(fraction * static_cast<float_t>(p));
+    }
+
     return ans;
 }
 
-} // namespace dckp_ienum
\ No newline at end of file
+} // namespace dckp_ienum
@@ -0,0 +1,259 @@
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <type_traits>
+
+#include <unistd.h>
+
+#include <dckp_ienum/instance_cache.hpp>
+#include <dckp_ienum/mapped_file.hpp>
+#include <dckp_ienum/profiler.hpp>
+
+namespace dckp_ienum {
+
+namespace {
+
+constexpr char MAGIC[8] = { 'D', 'C', 'K', 'P', 'I', 'N', 'S', 'T' };
+constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr std::size_t SECTION_ALIGNMENT = 64;
+
+enum Section : std::size_t {
+    O2S_INDICES,
+    S2O_INDICES,
+    WEIGHTS,
+    PROFITS,
+    WEIGHT_PREFIX,
+    PROFIT_PREFIX,
+    ADJACENCY_OFFSETS,
+    ADJACENCY_SPLITS,
+    ADJACENCY,
+    CONFLICT_MATRIX,
+    NUM_SECTIONS
+};
+
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t source_hash;
+    std::uint64_t source_size;
+    std::uint32_t num_items;
+    std::uint32_t capacity;
+    std::uint64_t num_conflicts;
+    std::uint64_t conflict_matrix_words;
+    std::uint64_t section_offsets[NUM_SECTIONS];
+};
+
+static_assert(std::is_trivially_copyable_v<CacheHeader>);
+static_assert(sizeof(item_index_t) == sizeof(std::uint32_t) && sizeof(int_weight_t) == sizeof(std::uint32_t));
+static_assert(sizeof(conflict_index_t) == sizeof(std::uint32_t));
+
+constexpr std::uint64_t align_up(std::uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+// Size in bytes of each section
+std::array<std::uint64_t, NUM_SECTIONS> section_sizes(std::uint64_t num_items, std::uint64_t num_conflicts, std::uint64_t conflict_matrix_words) {
+    std::array<std::uint64_t, NUM_SECTIONS> sizes;
+    sizes[O2S_INDICES] = num_items * sizeof(item_index_t);
+    sizes[S2O_INDICES] = num_items * sizeof(item_index_t);
+    sizes[WEIGHTS] = num_items * sizeof(int_weight_t);
+    sizes[PROFITS] = num_items * sizeof(int_profit_t);
+    sizes[WEIGHT_PREFIX] = (num_items + 1) * sizeof(weight_sum_t);
+    sizes[PROFIT_PREFIX] = (num_items + 1) * sizeof(profit_sum_t);
+    sizes[ADJACENCY_OFFSETS] = (num_items + 1) * sizeof(conflict_index_t);
+    sizes[ADJACENCY_SPLITS] = num_items * sizeof(conflict_index_t);
+    sizes[ADJACENCY] = 2 * num_conflicts * sizeof(item_index_t);
+    sizes[CONFLICT_MATRIX] = conflict_matrix_words * sizeof(Bitset::word_t);
+    return sizes;
+}
+
+// View of a section of a mapped cache file, in place
+template <typename T>
+Span<const T> section_span(const MappedFile& file, const CacheHeader& header, Section section, std::size_t count) {
+    return { reinterpret_cast<const T*>(file.data() + header.section_offsets[section]), count };
+}
+
+std::string cache_file_name(std::uint64_t source_hash) {
+    std::ostringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << source_hash << ".dckp";
+    return os.str();
+}
+
+inline std::uint64_t rotl(std::uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+} // namespace
+
+InstanceCache::InstanceCache(std::filesystem::path dir) : m_dir(std::move(dir)) {
+    std::filesystem::create_directories(m_dir);
+}
+
+std::uint64_t InstanceCache::hash(std::string_view data) {
+    // Multiply-rotate hash, one 64-bit word at a time. It only needs to tell instance files apart.
+    constexpr std::uint64_t k0 = 0x9E3779B97F4A7C15ull;
+    constexpr std::uint64_t k1 = 0xC2B2AE3D27D4EB4Full;
+
+    std::uint64_t h = k0 ^ data.size();
+
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= data.size(); i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, data.data() + i, sizeof(word));
+        h ^= rotl(word * k1, 31) * k0;
+        h = rotl(h, 27) * k0 + k1;
+    }
+
+    // data.data() may be null when data is empty, which memcpy does not accept even for 0 bytes
+    std::uint64_t tail = 0;
+    if (i < data.size()) {
+        std::memcpy(&tail, data.data() + i, data.size() - i);
+    }
+    h ^= rotl(tail * k1, 31) * k0;
+
+    // Final avalanche
+    h ^= h >> 33;
+    h *= k1;
+    h ^= h >> 29;
+    return h;
+}
+
+void InstanceCache::write(const std::filesystem::path& path, const Instance& instance, std::uint64_t source_hash, std::uint64_t source_size) {
+    profiler::ScopedTicToc tictoc("instance_cache_write");
+
+    CacheHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.source_hash = source_hash;
+    header.source_size = source_size;
+    header.num_items = instance.num_items();
+    header.capacity = instance.capacity();
+    header.num_conflicts = instance.num_conflicts();
+    header.conflict_matrix_words = instance.m_conflict_matrix.size();
+
+    const std::array<const void*, NUM_SECTIONS> section_data = {
+        instance.m_o2s_indices.data(),
+        instance.m_s2o_indices.data(),
+        instance.m_weights.data(),
+        instance.m_profits.data(),
+        instance.m_weight_prefix.data(),
+        instance.m_profit_prefix.data(),
+        instance.m_adjacency_offsets.data(),
+        instance.m_adjacency_splits.data(),
+        instance.m_adjacency.data(),
+        instance.m_conflict_matrix.data(),
+    };
+    const auto sizes = section_sizes(header.num_items, header.num_conflicts, header.conflict_matrix_words);
+
+    std::uint64_t offset = sizeof(CacheHeader);
+    for (std::size_t s = 0; s < NUM_SECTIONS; ++s) {
+        offset = align_up(offset);
+        header.section_offsets[s] = offset;
+        offset += sizes[s];
+    }
+
+    // Write to a temporary file first, so that concurrent runs never see a partial cache file
+    std::filesystem::path tmp_path = path;
+    tmp_path += ".tmp." + std::to_string(::getpid());
+
+    {
+        std::ofstream out;
+        out.exceptions(std::ios::badbit | std::ios::failbit);
+        out.open(tmp_path, std::ios::binary | std::ios::trunc);
+
+        static constexpr char padding[SECTION_ALIGNMENT] = {};
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::uint64_t written = sizeof(header);
+        for (std::size_t s = 0; s < NUM_SECTIONS; ++s) {
+            out.write(padding, static_cast<std::streamsize>(header.section_offsets[s] - written));
+            out.write(static_cast<const char*>(section_data[s]), static_cast<std::streamsize>(sizes[s]));
+            written = header.section_offsets[s] + sizes[s];
+        }
+    }
+
+    std::filesystem::rename(tmp_path, path);
+}
+
+bool InstanceCache::read(const std::filesystem::path& path, std::uint64_t source_hash, std::uint64_t source_size, Instance& instance) {
+    profiler::ScopedTicToc tictoc("instance_cache_read");
+
+    if (not std::filesystem::exists(path)) {
+        return false;
+    }
+
+    auto file = std::make_shared<MappedFile>(path, MappedFile::Access::Random);
+    if (file->size() < sizeof(CacheHeader)) {
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.version != FORMAT_VERSION
+        || header.byte_order != BYTE_ORDER_MARK
+        || header.source_hash != source_hash
+        || header.source_size != source_size)
+    {
+        return false;
+    }
+
+    const auto sizes = section_sizes(header.num_items, header.num_conflicts, header.conflict_matrix_words);
+    for (std::size_t s = 0; s < NUM_SECTIONS; ++s) {
+        if (header.section_offsets[s] % SECTION_ALIGNMENT != 0 || header.section_offsets[s] + sizes[s] > file->size()) {
+            return false;
+        }
+    }
+
+    instance.m_num_items = header.num_items;
+    instance.m_capacity = header.capacity;
+    instance.m_o2s_indices = section_span<item_index_t>(*file, header, O2S_INDICES, header.num_items);
+    instance.m_s2o_indices = section_span<item_index_t>(*file, header, S2O_INDICES, header.num_items);
+    instance.m_weights = section_span<int_weight_t>(*file, header, WEIGHTS, header.num_items);
+    instance.m_profits = section_span<int_profit_t>(*file, header, PROFITS, header.num_items);
+    instance.m_weight_prefix = section_span<weight_sum_t>(*file, header, WEIGHT_PREFIX, header.num_items + 1);
+    instance.m_profit_prefix = section_span<profit_sum_t>(*file, header, PROFIT_PREFIX, header.num_items + 1);
+    instance.m_adjacency_offsets = section_span<conflict_index_t>(*file, header, ADJACENCY_OFFSETS, header.num_items + 1);
+    instance.m_adjacency_splits = section_span<conflict_index_t>(*file, header, ADJACENCY_SPLITS, header.num_items);
+    instance.m_adjacency = section_span<item_index_t>(*file, header, ADJACENCY, 2 * header.num_conflicts);
+    instance.m_conflict_matrix = section_span<Bitset::word_t>(*file, header, CONFLICT_MATRIX, header.conflict_matrix_words);
+    instance.m_storage = std::move(file);
+
+    const bool bad_matrix = header.conflict_matrix_words != 0 && header.conflict_matrix_words != header.num_items * Bitset::num_words(header.num_items);
+    if (bad_matrix || (header.num_items > 0 && instance.m_adjacency_offsets[header.num_items] != 2 * header.num_conflicts)) {
+        instance = Instance {};
+        return false;
+    }
+
+    return true;
+}
+
+Instance InstanceCache::load(const std::filesystem::path& source) const {
+    std::uint64_t source_hash;
+    std::uint64_t source_size;
+    {
+        profiler::ScopedTicToc tictoc("instance_cache_hash");
+        const MappedFile file(source);
+        source_hash = hash(file.view());
+        source_size = file.size();
+    }
+
+    const auto path = m_dir / cache_file_name(source_hash);
+
+    Instance instance;
+    if (read(path, source_hash, source_size, instance)) {
+        return instance;
+    }
+
+    instance.parse(source);
+    instance.sort_items();
+    write(path, instance, source_hash, source_size);
+    return instance;
+}
+
+} // namespace dckp_ienum
@@ -1,170 +1,408 @@
 #include "dckp_ienum/types.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <charconv>
+#include <cstring>
 #include <numeric>
-#include <fstream>
-#include <string>
-#include <regex>
+#include <sstream>
+#include <string_view>
 
 #include <Eigen/Dense>
 
 #include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/mapped_file.hpp>
 #include <dckp_ienum/profiler.hpp>
 
 namespace dckp_ienum {
 
-namespace regexes {
+// Splits the mapped file in lines, without copying them.
+class LineCursor {
+    std::string_view m_buffer;
+    std::size_t m_pos = 0;
+    std::size_t m_line_no = 0;
 
-static const std::regex n("^param n := (\\d+);$");
-static const std::regex c("^param c := (\\d+);?$");
-static const std::regex vertices_hdr("^param : V : p w :=$");
-static const std::regex conflicts_hdr("^set E :=$");
-static const std::regex vertex("^\\s+(\\d+)\\s+(\\d+)\\s+(\\d+)$");
-static const std::regex conflict("^\\s+(\\d+)\\s+(\\d+)$");
-static const std::regex semicolon("^;$");
-static const std::regex empty("^$");
+public:
+    LineCursor(std::string_view buffer) : m_buffer(buffer) {}
 
-} // namespace regexes
+    bool eof() const { return m_pos >= m_buffer.size(); }
+    std::size_t line_no() const { return m_line_no; }
 
-template <typename... T>
-static void parse_line(const std::string& line, const std::regex& regex, const std::string& message, std::smatch& matches_buf, T&... vars) {
-    constexpr auto EXPECTED_MATCHES_COUNT = sizeof...(vars) + 1;
-    
-    if (std::regex_search(line, matches_buf, regex)) {
-        auto actual_matches_count = matches_buf.size();
+    // Past the end of the buffer, this returns empty lines
+    std::string_view next() {
+        ++m_line_no;
+        if (eof()) {
+            return {};
+        }
+
+        const char* begin = m_buffer.data() + m_pos;
+        const std::size_t left = m_buffer.size() - m_pos;
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', left));
+        const std::size_t len = newline ? static_cast<std::size_t>(newline - begin) : left;
 
-        if (actual_matches_count == EXPECTED_MATCHES_COUNT) {
-            std::size_t idx = 1;
+        m_pos += len + 1;
+        return { begin, len };
+    }
+};
 
-            ([&idx, &matches_buf](T& x){
-                std::from_chars(matches_buf[idx].first.base(), matches_buf[idx].second.base(), x);
-                ++idx;
-            }(vars), ...);
+// Matches a single line against the building blocks of the AMPL-style grammar.
+class LineScanner {
+    const char* m_it;
+    const char* m_end;
 
-            (void)idx;
-        } else {
-            std::ostringstream os;
-            os << "Regex \"" << message << "\" matches " << actual_matches_count << " groups, but invocation is expecting " << EXPECTED_MATCHES_COUNT << "!";
-            throw std::invalid_argument(os.str());
+    static bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+public:
+    LineScanner(std::string_view line) : m_it(line.data()), m_end(line.data() + line.size()) {}
+
+    bool literal(std::string_view text) {
+        if (static_cast<std::size_t>(m_end - m_it) < text.size() || std::memcmp(m_it, text.data(), text.size()) != 0) {
+            return false;
+        }
+        m_it += text.size();
+        return true;
+    }
+
+    bool optional(char c) {
+        if (m_it != m_end && *m_it == c) {
+            ++m_it;
+        }
+        return true;
+    }
+
+    // One or more whitespace characters (\s+)
+    bool spaces() {
+        const char* begin = m_it;
+        while (m_it != m_end && is_space(*m_it)) {
+            ++m_it;
+        }
+        return m_it != begin;
+    }
+
+    // One or more decimal digits (\d+), which must fit in T
+    template <typename T>
+    bool number(T& value) {
+        if (m_it == m_end || *m_it < '0' || *m_it > '9') {
+            return false;
+        }
+        auto [ptr, ec] = std::from_chars(m_it, m_end, value);
+        m_it = ptr;
+        return ec == std::errc {};
+    }
+
+    bool end() const { return m_it == m_end; }
+};
+
+namespace lines {
+
+static bool n(std::string_view line, item_index_t& n) {
+    LineScanner s(line);
+    return s.literal("param n := ") && s.number(n) && s.literal(";") && s.end();
+}
+static bool c(std::string_view line, int_weight_t& c) {
+    LineScanner s(line);
+    return s.literal("param c := ") && s.number(c) && s.optional(';') && s.end();
+}
+static bool vertices_hdr(std::string_view line) {
+    return line == "param : V : p w :=";
+}
+static bool conflicts_hdr(std::string_view line) {
+    return line == "set E :=";
+}
+static bool vertex(std::string_view line, item_index_t& i, int_profit_t& p, int_weight_t& w) {
+    LineScanner s(line);
+    return s.spaces() && s.number(i) && s.spaces() && s.number(p) && s.spaces() && s.number(w) && s.end();
+}
+static bool conflict(std::string_view line, item_index_t& i, item_index_t& j) {
+    LineScanner s(line);
+    return s.spaces() && s.number(i) && s.spaces() && s.number(j) && s.end();
+}
+static bool semicolon(std::string_view line) {
+    return line == ";";
+}
+static bool empty(std::string_view line) {
+    return line.empty();
+}
+
+} // namespace lines
+
+[[noreturn]] static void throw_bad_line(const LineCursor& cursor, const char* name) {
+    std::ostringstream os;
+    os << "Bad instance! Line " << cursor.line_no() << " could not be matched as \"" << name << "\".";
+    throw BadInstanceException(os.str());
+}
+
+void InstanceData::build_adjacency(item_index_t num_items, const std::vector<InstanceConflict>& edges) {
+    // Count the degree of each item, then turn the counts into row offsets
+    adjacency_offsets.assign(num_items + 1, 0);
+    for (const auto& edge : edges) {
+        ++adjacency_offsets[edge.i + 1];
+        ++adjacency_offsets[edge.j + 1];
+    }
+    std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(), adjacency_offsets.begin());
+
+    std::vector<conflict_index_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+    adjacency.resize(2 * edges.size());
+    for (const auto& edge : edges) {
+        adjacency[fill[edge.i]++] = edge.j;
+        adjacency[fill[edge.j]++] = edge.i;
+    }
+
+    // Sort each row and drop the repeated neighbours (a conflict may be listed twice, e.g. as "i j" and "j i"),
+    // compacting the rows in place
+    adjacency_splits.resize(num_items);
+    conflict_index_t pos = 0;
+    for (item_index_t i = 0; i < num_items; ++i) {
+        auto row_begin = adjacency.begin() + adjacency_offsets[i];
+        auto row_end = adjacency.begin() + adjacency_offsets[i + 1];
+        std::sort(row_begin, row_end);
+        row_end = std::unique(row_begin, row_end);
+
+        adjacency_offsets[i] = pos;
+        auto new_begin = adjacency.begin() + pos;
+        auto new_end = new_begin == row_begin? row_end : std::copy(row_begin, row_end, new_begin);
+        pos = static_cast<conflict_index_t>(new_end - adjacency.begin());
+        adjacency_splits[i] = static_cast<conflict_index_t>(std::upper_bound(new_begin, new_end, i) - adjacency.begin());
+    }
+    adjacency_offsets[num_items] = pos;
+    adjacency.resize(pos);
+}
+
+void InstanceData::build_conflict_matrix(item_index_t num_items) {
+    conflict_matrix.clear();
+
+    const std::size_t row_words = Bitset::num_words(num_items);
+    const float_t max_conflicts = static_cast<float_t>(num_items) * static_cast<float_t>(num_items - 1) / 2;
+    const float_t density = num_items > 1 ? static_cast<float_t>(adjacency.size() / 2) / max_conflicts : 0;
+
+    if (density < CONFLICT_MATRIX_MIN_DENSITY || num_items * row_words * sizeof(Bitset::word_t) > CONFLICT_MATRIX_MAX_BYTES) {
+        return;
+    }
+
+    conflict_matrix.assign(num_items * row_words, 0);
+    for (item_index_t i = 0; i < num_items; ++i) {
+        Bitset::word_t* row = conflict_matrix.data() + i * row_words;
+        for (conflict_index_t k = adjacency_offsets[i]; k < adjacency_offsets[i + 1]; ++k) {
+            item_index_t j = adjacency[k];
+            row[j / Bitset::WORD_BITS] |= Bitset::word_t(1) << (j % Bitset::WORD_BITS);
         }
-    } else {
-        std::ostringstream os;
-        os << "Bad instance! Regex \"" << message << "\" could not be matched.";
-        throw BadInstanceException(os.str());
     }
 }
 
+void InstanceData::build_prefix_sums() {
+    weight_prefix.assign(weights.size() + 1, 0);
+    profit_prefix.assign(profits.size() + 1, 0);
+    for (std::size_t i = 0; i < weights.size(); ++i) {
+        weight_prefix[i + 1] = weight_prefix[i] + weights[i];
+        profit_prefix[i + 1] = profit_prefix[i] + profits[i];
+    }
+}
+
+void Instance::set_data(std::shared_ptr<InstanceData> data, item_index_t num_items, int_weight_t capacity) {
+    data->build_conflict_matrix(num_items);
+    data->build_prefix_sums();
+
+    m_num_items = num_items;
+    m_capacity = capacity;
+
+    m_o2s_indices = { data->o2s_indices.data(), data->o2s_indices.size() };
+    m_s2o_indices = { data->s2o_indices.data(), data->s2o_indices.size() };
+    m_weights = { data->weights.data(), data->weights.size() };
+    m_profits = { data->profits.data(), data->profits.size() };
+    m_weight_prefix = { data->weight_prefix.data(), data->weight_prefix.size() };
+    m_profit_prefix = { data->profit_prefix.data(), data->profit_prefix.size() };
+    m_adjacency_offsets = { data->adjacency_offsets.data(), data->adjacency_offsets.size() };
+    m_adjacency_splits = { data->adjacency_splits.data(), data->adjacency_splits.size() };
+    m_adjacency = { data->adjacency.data(), data->adjacency.size() };
+    m_conflict_matrix = { data->conflict_matrix.data(), data->conflict_matrix.size() };
+
+    m_storage = std::move(data);
+}
+
 void Instance::clear() {
-    m_conflicts.clear();
-    m_num_items = 0;
+    *this = Instance {};
 }
 
-#define PARSE_LINE(name, ...) parse_line(line_buffer, regexes::name, #name, match_buffer __VA_OPT__(,) __VA_ARGS__)
-#define READ_PARSE_LINE(name, ...) do { \
-    std::getline(in, line_buffer); \
-    PARSE_LINE(name __VA_OPT__(,) __VA_ARGS__); \
-} while(false);
+#define PARSE_LINE(line, name, ...) do { \
+    if (not lines::name(line __VA_OPT__(,) __VA_ARGS__)) { \
+        throw_bad_line(cursor, #name); \
+    } \
+} while (false)
+#define READ_PARSE_LINE(name, ...) PARSE_LINE(cursor.next(), name __VA_OPT__(,) __VA_ARGS__)
 
 void Instance::parse(const std::filesystem::path& path) {
-    std::ifstream in(path);
-    std::string line_buffer;
-    std::smatch match_buffer;
+    profiler::ScopedTicToc tictoc("parse");
+
+    const MappedFile file(path);
+    LineCursor cursor(file.view());
+
+    auto data = std::make_shared<InstanceData>();
 
-    READ_PARSE_LINE(n, m_num_items)
-    READ_PARSE_LINE(c, m_capacity);
+    item_index_t num_items;
+    int_weight_t capacity;
+    READ_PARSE_LINE(n, num_items);
+    READ_PARSE_LINE(c, capacity);
 
-    m_o2s_indices.resize(num_items());
-    std::iota(m_o2s_indices.begin(), m_o2s_indices.end(), 0);
+    data->o2s_indices.resize(num_items);
+    std::iota(data->o2s_indices.begin(), data->o2s_indices.end(), 0);
 
-    m_s2o_indices.resize(num_items());
-    std::iota(m_s2o_indices.begin(), m_s2o_indices.end(), 0);
+    data->s2o_indices.resize(num_items);
+    std::iota(data->s2o_indices.begin(), data->s2o_indices.end(), 0);
 
-    m_weights.resize(num_items());
-    m_profits.resize(num_items());
+    data->weights.resize(num_items);
+    data->profits.resize(num_items);
     
     READ_PARSE_LINE(vertices_hdr);
 
-    for (item_index_t i = 0; i < num_items(); ++i) {
+    for (item_index_t i = 0; i < num_items; ++i) {
         item_index_t file_id;
-        READ_PARSE_LINE(vertex, file_id, m_profits(i), m_weights(i));
+        READ_PARSE_LINE(vertex, file_id, data->profits[i], data->weights[i]);
         if (file_id != i) {
-            throw BadInstanceException("vertices are not continuous");
+            std::ostringstream os;
+            os << "Bad instance! Line " << cursor.line_no() << ": vertices are not continuous.";
+            throw BadInstanceException(os.str());
         }
     }
     READ_PARSE_LINE(semicolon);
     READ_PARSE_LINE(empty);
     READ_PARSE_LINE(conflicts_hdr);
 
+    std::vector<InstanceConflict> edges;
     while (true) {
-        std::getline(in, line_buffer);
-        
-        try {
-            // List ends on the semicolon line
-            PARSE_LINE(semicolon);
+        const std::string_view line = cursor.next();
+
+        // List ends on the semicolon line
+        if (lines::semicolon(line)) {
             break;
         }
-        catch (const BadInstanceException&) {}
 
-        auto& new_conflict = m_conflicts.emplace_back();
-        PARSE_LINE(conflict, new_conflict.i, new_conflict.j);
+        auto& new_conflict = edges.emplace_back();
+        PARSE_LINE(line, conflict, new_conflict.i, new_conflict.j);
+
+        if (new_conflict.i >= num_items || new_conflict.j >= num_items || new_conflict.i == new_conflict.j) {
+            std::ostringstream os;
+            os << "Bad instance! Line " << cursor.line_no() << ": invalid conflict " << new_conflict << ".";
+            throw BadInstanceException(os.str());
+        }
     }
 
     // Ensure leftover content consists of empty lines
-    while (not in.eof()) {
+    while (not cursor.eof()) {
         READ_PARSE_LINE(empty);
     }
+
+    data->build_adjacency(num_items, edges);
+
+    set_data(std::move(data), num_items, capacity);
 }
 
 void Instance::sort_items() {
     profiler::tic("sort_items");
-    
-    std::sort(m_s2o_indices.begin(), m_s2o_indices.end(), [&](item_index_t a, item_index_t b) {
-        float_t pwr_a = static_cast<float_t>(m_profits(a)) / static_cast<float_t>(m_weights(a));
-        float_t pwr_b = static_cast<float_t>(m_profits(b)) / static_cast<float_t>(m_weights(b));
+
+    auto data = std::make_shared<InstanceData>();
+
+    // Storage order of the current items, by decreasing p/w ratio
+    std::vector<item_index_t> order(num_items());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](item_index_t a, item_index_t b) {
+        float_t pwr_a = static_cast<float_t>(m_profits[a]) / static_cast<float_t>(m_weights[a]);
+        float_t pwr_b = static_cast<float_t>(m_profits[b]) / static_cast<float_t>(m_weights[b]);
         return pwr_a > pwr_b;
     });
 
     // Compute a map from the old indices to the new
-    for (unsigned int i = 0; i < m_num_items; ++i) {
-        m_o2s_indices(m_s2o_indices(i)) = i;
+    std::vector<item_index_t> old2new(num_items());
+    for (item_index_t i = 0; i < num_items(); ++i) {
+        old2new[order[i]] = i;
     }
 
-    m_rconflicts = m_conflicts;
+    data->s2o_indices.resize(num_items());
+    data->o2s_indices.resize(num_items());
+    for (item_index_t i = 0; i < num_items(); ++i) {
+        data->s2o_indices[i] = m_s2o_indices[order[i]];
+        data->o2s_indices[data->s2o_indices[i]] = i;
+    }
 
-    // Update the conflict map with the new indices, and normalize the conflicts (i <= j)
-    for (conflict_index_t conflict_idx = 0; conflict_idx < m_conflicts.size(); ++conflict_idx) {
-        auto& conflict = m_conflicts[conflict_idx];
-        auto& rconflict = m_rconflicts[conflict_idx];
+    // Rename the neighbours of each item, then sort each row again
+    data->adjacency_offsets.resize(num_items() + 1);
+    data->adjacency_splits.resize(num_items());
+    data->adjacency.resize(m_adjacency.size());
 
-        item_index_t i = m_o2s_indices(conflict.i);
-        item_index_t j = m_o2s_indices(conflict.j);
+    conflict_index_t pos = 0;
+    for (item_index_t i = 0; i < num_items(); ++i) {
+        data->adjacency_offsets[i] = pos;
+        for (item_index_t old_j : conflicts(order[i])) {
+            data->adjacency[pos++] = old2new[old_j];
+        }
 
-        // Conflict has i<=j
-        // Rconflict has i>=j
-        rconflict.j = conflict.i = std::min(i, j);
-        rconflict.i = conflict.j = std::max(i, j);
+        auto row_begin = data->adjacency.begin() + data->adjacency_offsets[i];
+        auto row_end = data->adjacency.begin() + pos;
+        std::sort(row_begin, row_end);
+        data->adjacency_splits[i] = static_cast<conflict_index_t>(std::upper_bound(row_begin, row_end, i) - data->adjacency.begin());
     }
-
-    // Sort conflicts by i
-    std::sort(m_conflicts.begin(), m_conflicts.end(), InstanceConflict::IndexLt{});
-    std::sort(m_rconflicts.begin(), m_rconflicts.end(), InstanceConflict::IndexLt{});
+    data->adjacency_offsets[num_items()] = pos;
 
     // Reorder profits and weights
-    decltype(m_profits) profits;
-    decltype(m_weights) weights;
-    profits.resizeLike(m_profits);
-    weights.resizeLike(m_weights);
-
+    data->profits.resize(num_items());
+    data->weights.resize(num_items());
     for (item_index_t i = 0; i < num_items(); ++i) {
-        profits(m_o2s_indices(i)) = m_profits(i);
-        weights(m_o2s_indices(i)) = m_weights(i);
+        data->profits[i] = m_profits[order[i]];
+        data->weights[i] = m_weights[order[i]];
     }
 
-    m_profits = profits;
-    m_weights = weights;
+    set_data(std::move(data), num_items(), capacity());
 
     profiler::toc("sort_items");
 }
 
-} // namespace dckp_ienum
\ No newline at end of file
+Instance Instance::subinstance(const std::vector<item_index_t>& items, int_weight_t capacity) const {
+    profiler::ScopedTicToc tictoc("subinstance");
+
+    auto data = std::make_shared<InstanceData>();
+    const item_index_t n = static_cast<item_index_t>(items.size());
+
+    // Compute a map from the old indices to the new
+    std::vector<item_index_t> old2new(num_items(), invalid_v<item_index_t>);
+    for (item_index_t i = 0; i < n; ++i) {
+        old2new[items[i]] = i;
+    }
+
+    data->s2o_indices.resize(n);
+    data->o2s_indices.assign(m_o2s_indices.size(), invalid_v<item_index_t>);
+    for (item_index_t i = 0; i < n; ++i) {
+        data->s2o_indices[i] = m_s2o_indices[items[i]];
+        data->o2s_indices[data->s2o_indices[i]] = i;
+    }
+
+    // Rename the neighbours that are kept. The order is kept, so the rows stay sorted.
+    data->adjacency_offsets.resize(n + 1);
+    data->adjacency_splits.resize(n);
+
+    for (item_index_t i = 0; i < n; ++i) {
+        data->adjacency_offsets[i] = static_cast<conflict_index_t>(data->adjacency.size());
+        for (item_index_t old_j : conflicts(items[i])) {
+            if (old2new[old_j] != invalid_v<item_index_t>) {
+                data->adjacency.push_back(old2new[old_j]);
+            }
+        }
+
+        auto row_begin = data->adjacency.begin() + data->adjacency_offsets[i];
+        data->adjacency_splits[i] = static_cast<conflict_index_t>(std::upper_bound(row_begin, data->adjacency.end(), i) - data->adjacency.begin());
+    }
+    data->adjacency_offsets[n] = static_cast<conflict_index_t>(data->adjacency.size());
+
+    data->profits.resize(n);
+    data->weights.resize(n);
+    for (item_index_t i = 0; i < n; ++i) {
+        data->profits[i] = m_profits[items[i]];
+        data->weights[i] = m_weights[items[i]];
+    }
+
+    Instance ans;
+    ans.set_data(std::move(data), n, capacity);
+    return ans;
+}
+
+} // namespace dckp_ienum
@@ -1,4 +1,6 @@
 #include "dckp_ienum/types.hpp"
+#include <algorithm>
+#include <cmath>
 #include <optional>
 #include <numeric>
 #include <limits>
@@ -21,6 +23,8 @@ namespace dckp_ienum {
 #ifdef ENABLE_TELEMETRY
 struct Telemetry {
     float_t Lk;
+    float_t ub;
+    float_t step;
     float_t lambda_norm;
     float_t dlambda_norm;
     std::size_t k;
@@ -29,21 +33,28 @@ struct Telemetry {
     void serialize(Archive& ar) {
         ar(cereal::make_nvp("k", k));
         ar(cereal::make_nvp("Lk", Lk));
+        ar(cereal::make_nvp("ub", ub));
+        ar(cereal::make_nvp("step", step));
         ar(cereal::make_nvp("lambda_norm", lambda_norm));
         ar(cereal::make_nvp("dlambda_norm", dlambda_norm));
     }
 };
 #endif // ENABLE_TELEMETRY
 
+int_profit_t LdckpResult::int_ub() const {
+    if (ub >= static_cast<float_t>(std::numeric_limits<int_profit_t>::max())) {
+        return std::numeric_limits<int_profit_t>::max();
+    }
+    return static_cast<int_profit_t>(std::floor(ub + LDCKP_UB_TOLERANCE));
+}
+
 void LdckpResult::convert(const Instance& instance, Solution &soln, item_index_t jp1) {
     profiler::ScopedTicToc tictoc("convert_ldckp");
 
-    soln.ub = ub;
-
-    for (item_index_t ldckp_i = 0; ldckp_i < x.size(); ++ldckp_i) {
-        item_index_t item_i = ldckp_i + jp1;
+    soln.ub = int_ub();
 
-        if (x(ldckp_i) == 1.0) {
+    for (item_index_t item_i = jp1; item_i < instance.num_items(); ++item_i) {
+        if (x(item_i) == 1.0) {
             soln.x[item_i] = true;
             soln.p += instance.profit(item_i);
             soln.w += instance.weight(item_i);
@@ -53,45 +64,201 @@ void LdckpResult::convert(const Instance& instance, Solution &soln, item_index_t
     }
 }
 
-LdckpResult solve_ldckp(const Instance& instance, std::vector<bool> fixed_items, item_index_t jp1, int_profit_t fixed_items_p, int_weight_t fixed_items_w, ConflictConstIterator jp1th_rconflict_begin, const LdckpSolverParams& params) {
+/*
+Fractional knapsack over the items in [begin, end), all with positive profit, in expected linear time (Balas-Zemel).
+Rather than sorting the items by ratio, they are partitioned around a pivot ratio:
+if the items above the pivot do not fit, the critical item is among them, otherwise they are all taken
+and the search goes on below the pivot. Each round drops one side, so the work is linear on average.
+Sets x of the items taken, entirely or in part (x must be zero on entry), and returns their profit.
+*/
+template <typename Vector, typename Weights>
+static float_t solve_fractional_knapsack(item_index_t* begin, item_index_t* end, const Vector& ratios, const Vector& ps, const Weights& ws, int_weight_t capacity, Vector& x) {
+    float_t profit = 0;
+
+    while (begin < end) {
+        // Median of three as the pivot
+        float_t a = ratios(*begin);
+        float_t b = ratios(*(begin + (end - begin) / 2));
+        float_t c = ratios(*(end - 1));
+        const float_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        // [begin, above): ratio > pivot, [above, equal): ratio == pivot, [equal, end): ratio < pivot
+        item_index_t* above = std::partition(begin, end, [&](item_index_t i) { return ratios(i) > pivot; });
+        item_index_t* equal = std::partition(above, end, [&](item_index_t i) { return ratios(i) == pivot; });
+
+        weight_sum_t above_w = 0;
+        for (item_index_t* it = begin; it != above; ++it) {
+            above_w += ws(*it);
+        }
+
+        if (above_w > capacity) {
+            end = above;
+            continue;
+        }
+
+        for (item_index_t* it = begin; it != above; ++it) {
+            x(*it) = 1.0;
+            profit += ps(*it);
+        }
+        capacity -= static_cast<int_weight_t>(above_w);
+
+        // Items with the pivot ratio are interchangeable
+        for (item_index_t* it = above; it != equal; ++it) {
+            if (ws(*it) <= capacity) {
+                x(*it) = 1.0;
+                profit += ps(*it);
+                capacity -= ws(*it);
+            } else {
+                x(*it) = static_cast<float_t>(capacity) / static_cast<float_t>(ws(*it));
+                return profit + x(*it) * ps(*it);
+            }
+        }
+
+        begin = equal;
+    }
+
+    return profit;
+}
+
+void LdckpWorkspace::reserve(const Instance& instance, const CliqueCover* cliques) {
+    const item_index_t n = instance.num_items();
+    const conflict_index_t m = cliques? cliques->num_cliques() : instance.num_conflicts();
+    const std::size_t members = cliques? cliques->size() : 2 * static_cast<std::size_t>(instance.num_conflicts());
+
+    if (m_x.size() != n) {
+        m_x.resize(n);
+        m_ps.resize(n);
+        m_ratios.resize(n);
+        m_indices.resize(n);
+    }
+
+    // Grown only, so that alternating between the two relaxations does not reallocate
+    if (m_member_offsets.size() < static_cast<std::size_t>(m) + 1) {
+        m_lambdak.resize(m);
+        m_dlambdak.resize(m);
+        m_best_lambdak.resize(m);
+        m_rhs.resize(m);
+        m_member_offsets.resize(m + 1);
+    }
+    if (m_members.size() < members) {
+        m_members.resize(members);
+    }
+}
+
+void solve_ldckp(const Instance& instance, const Bitset& fixed_items, item_index_t jp1, int_profit_t fixed_items_p, int_weight_t fixed_items_w, const LdckpSolverParams& params, LdckpWorkspace& workspace, LdckpResult& ans, const LdckpMultipliers* warm_start) {
     profiler::ScopedTicToc tictoc("solve_ldckp");
 
-    LdckpResult ans;
+    workspace.reserve(instance, params.cliques);
+    ans.x.resize(instance.num_items());
+    ans.ub = std::numeric_limits<float_t>::max();
 
-    const auto rconflict_end = instance.rconflicts().end();
-    
     item_index_t n = instance.num_items() - jp1;
-    conflict_index_t m = std::distance(jp1th_rconflict_begin, rconflict_end);
+
+    // The dualised constraints of the subproblem, sum of x over the free members <= rhs.
+    // Either a constraint for each conflict (i, j) with j < i and i >= jp1, in the order given by the backward
+    // conflicts of the items from jp1 onwards, or one for each clique with an item from jp1 onwards.
+    // In both cases they are a suffix of those of the whole instance, from first_constraint.
+    conflict_index_t first_constraint = 0;
+    conflict_index_t m = 0;
+    {
+        profiler::ScopedTicToc tictoc("ldckp_constraints");
+
+        std::size_t member = 0;
+        workspace.m_member_offsets[0] = 0;
+
+        if (params.cliques) {
+            first_constraint = params.cliques->first_clique(jp1);
+            for (conflict_index_t c = first_constraint; c < params.cliques->num_cliques(); ++c) {
+                // Items are sorted, the fixed ones come first
+                float_t rhs = 1.0;
+                for (item_index_t i : params.cliques->clique(c)) {
+                    if (i < jp1) {
+                        rhs -= fixed_items[i]? 1.0 : 0.0;
+                    } else {
+                        workspace.m_members[member++] = i - jp1;
+                    }
+                }
+                workspace.m_rhs(m++) = rhs;
+                workspace.m_member_offsets[m] = member;
+            }
+        } else {
+            for (item_index_t i = 0; i < jp1; ++i) {
+                first_constraint += instance.backward_conflicts(i).size();
+            }
+            for (item_index_t i = jp1; i < instance.num_items(); ++i) {
+                for (item_index_t j : instance.backward_conflicts(i)) {
+                    float_t rhs = 1.0;
+                    workspace.m_members[member++] = i - jp1;
+                    if (j >= jp1) {
+                        workspace.m_members[member++] = j - jp1;
+                    } else if (fixed_items[j]) {
+                        rhs = 0.0;
+                    }
+                    workspace.m_rhs(m++) = rhs;
+                    workspace.m_member_offsets[m] = member;
+                }
+            }
+        }
+    }
+
+    const item_index_t* members = workspace.m_members.data();
+    const conflict_index_t* member_offsets = workspace.m_member_offsets.data();
     
     auto ws = instance.weights().bottomRows(n).matrix();
-    Eigen::VectorX<float_t> x(n);
-    Eigen::VectorX<float_t> dlambdak(m);
-    Eigen::VectorX<float_t> lambdak(m);
-    Eigen::VectorX<float_t> ps(n);
-    
-    Eigen::ArrayX<item_index_t> indices(n);
-    std::iota(indices.begin(), indices.end(), 0);
+    auto rhs = workspace.m_rhs.head(m);
+    auto dlambdak = workspace.m_dlambdak.head(m);
+    auto lambdak = workspace.m_lambdak.head(m);
+    auto best_lambdak = workspace.m_best_lambdak.head(m);
+    auto ps = workspace.m_ps.head(n);
+    auto ratios = workspace.m_ratios.head(n);
+    auto indices = workspace.m_indices.head(n);
     
     lambdak.setZero();
 
-    for (std::size_t k = 0; k < params.k_max; ++k) {
-        float_t Lk = static_cast<float_t>(fixed_items_p) + lambdak.sum();
+    std::size_t k_max = params.k_max;
+    float_t alpha = params.alpha;
+    float_t theta = params.theta;
+    if (warm_start) {
+        // The multipliers of the constraints of the items before jp1 only are dropped
+        auto it = std::lower_bound(warm_start->begin(), warm_start->end(), first_constraint, [](const LdckpMultiplier& a, conflict_index_t c) {
+            return a.constraint < c;
+        });
+        for (; it != warm_start->end(); ++it) {
+            lambdak(it->constraint - first_constraint) = static_cast<float_t>(it->lambda);
+        }
+
+        k_max = params.warm_k_max;
+        alpha = params.warm_alpha;
+        theta = params.warm_theta;
+    }
+    best_lambdak = lambdak;
+
+    // No solution of the subproblem beats the incumbent once the bound is below lower_bound + 1 (profits are integers)
+    const float_t prune_below = static_cast<float_t>(params.lower_bound) + static_cast<float_t>(1.0) - LDCKP_UB_TOLERANCE;
+
+    // Polyak steps towards a target of 0 would be far too short
+    const LdckpStepPolicy step_policy = params.lower_bound > 0? params.step : LdckpStepPolicy::Constant;
+    std::size_t stall = 0;
+    float_t step = 0;
+
+    ans.iterations = 0;
+    for (std::size_t k = 0; k < k_max; ++k) {
+        ++ans.iterations;
+
+        // The best x so far is swapped into the result rather than copied, so take the view each time
+        auto x = workspace.m_x.tail(n);
+
+        float_t Lk = static_cast<float_t>(fixed_items_p) + lambdak.dot(rhs);
 
         {
             profiler::ScopedTicToc tictoc("ldckp_prep_ps");
 
             ps = instance.profits().bottomRows(n).cast<float_t>();
 
-            conflict_index_t cft_idx = 0;
-            for (auto it = jp1th_rconflict_begin; it != rconflict_end; ++it) {
-                float_t conflict_lambda = lambdak(cft_idx++);
-
-                auto i = it->i - jp1;
-                ps(i) -= conflict_lambda;
-                if (it->j >= jp1) {
-                    ps(it->j - jp1) -= conflict_lambda;
-                } else if (fixed_items[it->j]) {
-                    Lk -= conflict_lambda;
+            for (conflict_index_t c = 0; c < m; ++c) {
+                const float_t lambda = lambdak(c);
+                for (conflict_index_t l = member_offsets[c]; l < member_offsets[c + 1]; ++l) {
+                    ps(members[l]) -= lambda;
                 }
             }
         }
@@ -100,47 +267,66 @@ LdckpResult solve_ldckp(const Instance& instance, std::vector<bool> fixed_items,
         {
             profiler::ScopedTicToc tictoc("ldckp_fkp_solver");
 
-            int_weight_t int_weight = fixed_items_w;
-
-            // Sort indices by profit / weight ratio
-            std::sort(indices.begin(), indices.end(), [&](item_index_t a, item_index_t b) {
-                return (ps(a) / static_cast<float_t>(ws(a))) > (ps(b) / static_cast<float_t>(ws(b)));
-            });
-
-            // Greedily take items
             x.setZero();
-            for (item_index_t i = 0; i < n; ++i) 
-            {
-                const float_t p = ps(indices(i));
-                const int_weight_t w = ws(indices(i));
-                float_t& xi = x(indices(i));
-
-                // If taking this item doesn't profit us, stop
-                // Any item after this is even worse (we sorted them by p/w ratio)
-                if (p <= static_cast<float_t>(0.0)) {
-                    break;
-                }
 
-                const int_weight_t avail_c = instance.capacity() - int_weight;
-
-                if (w <= avail_c) {
-                    xi = static_cast<float_t>(1.0);
-                    Lk += p;
-                    int_weight += w;
-                } else {
-                    xi = static_cast<float_t>(avail_c) / static_cast<float_t>(w);
-                    Lk += xi * p;
-                    break;
+            if (params.fkp == LdckpFkpAlgorithm::Partition) {
+                // Only the items with a positive profit are worth taking
+                item_index_t num_candidates = 0;
+                for (item_index_t i = 0; i < n; ++i) {
+                    if (ps(i) > static_cast<float_t>(0.0)) {
+                        ratios(i) = ps(i) / static_cast<float_t>(ws(i));
+                        indices(num_candidates++) = i;
+                    }
+                }
+                Lk += solve_fractional_knapsack(indices.data(), indices.data() + num_candidates, ratios, ps, ws, instance.capacity() - fixed_items_w, x);
+            } else {
+                int_weight_t int_weight = fixed_items_w;
+
+                // Sort indices by profit / weight ratio
+                std::iota(indices.begin(), indices.end(), 0);
+                std::sort(indices.begin(), indices.end(), [&](item_index_t a, item_index_t b) {
+                    return (ps(a) / static_cast<float_t>(ws(a))) > (ps(b) / static_cast<float_t>(ws(b)));
+                });
+
+                // Greedily take items
+                for (item_index_t i = 0; i < n; ++i)
+                {
+                    const float_t p = ps(indices(i));
+                    const int_weight_t w = ws(indices(i));
+                    float_t& xi = x(indices(i));
+
+                    // If taking this item doesn't profit us, stop
+                    // Any item after this is even worse (we sorted them by p/w ratio)
+                    if (p <= static_cast<float_t>(0.0)) {
+                        break;
+                    }
+
+                    const int_weight_t avail_c = instance.capacity() - int_weight;
+
+                    if (w <= avail_c) {
+                        xi = static_cast<float_t>(1.0);
+                        Lk += p;
+                        int_weight += w;
+                    } else {
+                        xi = static_cast<float_t>(avail_c) / static_cast<float_t>(w);
+                        Lk += xi * p;
+                        break;
+                    }
                 }
             }
         }
 
         if (Lk < ans.ub) {
-            ans.x = x;
+            ans.x.swap(workspace.m_x);
             ans.ub = Lk;
+            best_lambdak = lambdak;
+            stall = 0;
+        } else if (++stall >= params.stall_iterations && step_policy == LdckpStepPolicy::Polyak) {
+            theta /= 2;
+            stall = 0;
         }
 
-        if (k >= params.k_max - 1) {
+        if (k >= k_max - 1 || ans.ub < prune_below || theta < params.min_theta) {
             break;
         }
 
@@ -149,14 +335,12 @@ LdckpResult solve_ldckp(const Instance& instance, std::vector<bool> fixed_items,
             profiler::ScopedTicToc tictoc("ldckp_sg_calc");
 
             // Compute gradient of lagrangian wrt lambda in lambdak
-            for (auto it = jp1th_rconflict_begin; it != rconflict_end; ++it) {
-                float_t& conflict_dlambda = dlambdak(std::distance(jp1th_rconflict_begin, it));
-    
-                conflict_dlambda = static_cast<float_t>(1.0) - x(it->i - jp1);
-                if (it->j >= jp1) {
-                    conflict_dlambda -= x(it->j - jp1);
-                } else if (fixed_items[it->j]) {
-                    conflict_dlambda -= 1.0;
+            for (conflict_index_t c = 0; c < m; ++c) {
+                float_t& constraint_dlambda = dlambdak(c);
+
+                constraint_dlambda = rhs(c);
+                for (conflict_index_t l = member_offsets[c]; l < member_offsets[c + 1]; ++l) {
+                    constraint_dlambda -= x(members[l]);
                 }
             }
         }
@@ -165,8 +349,19 @@ LdckpResult solve_ldckp(const Instance& instance, std::vector<bool> fixed_items,
         {
             profiler::ScopedTicToc tictoc("ldckp_sg_step");
 
-            float_t alpha = params.alpha;
-            lambdak -= alpha * dlambdak.normalized();
+            // A zero subgradient means that x satisfies all the conflicts, so Lk is optimal
+            const float_t norm2 = dlambdak.squaredNorm();
+            if (norm2 == static_cast<float_t>(0.0)) {
+                break;
+            }
+
+            // Step along the subgradient, without the temporary of normalized()
+            if (step_policy == LdckpStepPolicy::Polyak) {
+                step = theta * std::max(Lk - static_cast<float_t>(params.lower_bound), static_cast<float_t>(0.0)) / norm2;
+            } else {
+                step = alpha / std::sqrt(norm2);
+            }
+            lambdak -= step * dlambdak;
             lambdak = lambdak.cwiseMax(static_cast<float_t>(0.0));
         }
 
@@ -174,14 +369,29 @@ LdckpResult solve_ldckp(const Instance& instance, std::vector<bool> fixed_items,
         Telemetry tel;
         
         tel.Lk = Lk;
+        tel.ub = ans.ub;
+        tel.step = step;
         tel.dlambda_norm = dlambdak.norm();
         tel.lambda_norm = lambdak.norm();
         tel.k = k;
 
-        TelemetrySocket::get().send("ldckp_solver_" + std::to_string(params.alpha), tel);
+        TelemetrySocket::get().send(step_policy == LdckpStepPolicy::Polyak? "ldckp_solver_polyak" : "ldckp_solver_" + std::to_string(params.alpha), tel);
         #endif // ENABLE_TELEMETRY
     }
 
+    ans.multipliers.clear();
+    for (conflict_index_t c = 0; c < m; ++c) {
+        if (best_lambdak(c) > static_cast<float_t>(0.0)) {
+            ans.multipliers.push_back({ first_constraint + c, static_cast<float>(best_lambdak(c)) });
+        }
+    }
+}
+
+LdckpResult solve_ldckp(const Instance& instance, const Bitset& fixed_items, item_index_t jp1, int_profit_t fixed_items_p, int_weight_t fixed_items_w, const LdckpSolverParams& params) {
+    thread_local LdckpWorkspace workspace;
+
+    LdckpResult ans;
+    solve_ldckp(instance, fixed_items, jp1, fixed_items_p, fixed_items_w, params, workspace, ans);
     return ans;
 }
 
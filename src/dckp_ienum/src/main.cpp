@@ -10,15 +10,20 @@
 #include <fenv.h>
 
 #include <dckp_ienum/dckp_greedy_solver.hpp>
+#include <dckp_ienum/dckp_greedy_portfolio_solver.hpp>
 #include <dckp_ienum/solution_has_conflicts.hpp>
 #include <dckp_ienum/solution_ldckp_to_dckp.hpp>
 #include <dckp_ienum/dckp_relax_solver.hpp>
 #include <dckp_ienum/solution_sanity_check.hpp>
 #include <dckp_ienum/dckp_hillclimb_solver.hpp>
+#include <dckp_ienum/dckp_hillclimb_mt_solver.hpp>
+#include <dckp_ienum/dckp_tabu_solver.hpp>
 #include <dckp_ienum/dckp_bnb_solver.hpp>
 #include <dckp_ienum/solution_print.hpp>
 #include <dckp_ienum/ldckp_solver.hpp>
 #include <dckp_ienum/instance.hpp>
+#include <dckp_ienum/instance_cache.hpp>
+#include <dckp_ienum/probing.hpp>
 #include <dckp_ienum/profiler.hpp>
 #include <dckp_ienum/types.hpp>
 
@@ -40,26 +45,82 @@ struct Arguments {
     const Solver* solver;
     std::filesystem::path input;
     std::filesystem::path output;
+    std::filesystem::path cache_dir;
     bool list;
+    bool probe;
     std::chrono::seconds::rep timeout_s;
 };
 
+// Worker threads of the parallel solvers (0 = one per hardware thread)
+unsigned num_threads = 0;
+
+// Memory budget of the open nodes of B&B, in MB (0 = unlimited)
+std::size_t bnb_memory_mb = 0;
+
+static dckp_ienum::BnbParams bnb_params() {
+    dckp_ienum::BnbParams params;
+    params.memory_budget = bnb_memory_mb << 20;
+    return params;
+}
+
 std::unordered_map<std::string, Solver> solvers {
     {
         "relax", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
-            dckp_ienum::solve_dckp_relax(instance, soln, true, stop_token, cbk);
+            dckp_ienum::solve_dckp_relax(instance, soln, dckp_ienum::UpperBound::Ldckp, stop_token, cbk);
+        }
+    },
+    {
+        "relax-cliques", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::solve_dckp_relax(instance, soln, dckp_ienum::UpperBound::LdckpCliques, stop_token, cbk);
         }
     },
     {
         "bnb", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
-            dckp_ienum::solve_dckp_bnb(instance, soln, false, stop_token, cbk);
+            dckp_ienum::solve_dckp_bnb(instance, soln, dckp_ienum::UpperBound::Fkp, stop_token, cbk, bnb_params());
+        }
+    },
+    {
+        "bnb-clique-fkp", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::solve_dckp_bnb(instance, soln, dckp_ienum::UpperBound::CliqueFkp, stop_token, cbk, bnb_params());
+        }
+    },
+    {
+        "bnb-mt", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::BnbMtParams params;
+            params.num_threads = num_threads;
+            params.bnb = bnb_params();
+            dckp_ienum::solve_dckp_bnb_mt(instance, soln, dckp_ienum::UpperBound::Fkp, stop_token, cbk, params);
+        }
+    },
+    {
+        "bnb-clique-fkp-mt", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::BnbMtParams params;
+            params.num_threads = num_threads;
+            params.bnb = bnb_params();
+            dckp_ienum::solve_dckp_bnb_mt(instance, soln, dckp_ienum::UpperBound::CliqueFkp, stop_token, cbk, params);
+        }
+    },
+    {
+        "bnb-ldckp", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::solve_dckp_bnb(instance, soln, dckp_ienum::UpperBound::Ldckp, stop_token, cbk, bnb_params());
+        }
+    },
+    {
+        "bnb-cliques", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::solve_dckp_bnb(instance, soln, dckp_ienum::UpperBound::LdckpCliques, stop_token, cbk, bnb_params());
         }
     },
     {
         "ienum", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
-            // run greedy solver to get a lower bound
-            dckp_ienum::solve_dckp_greedy(instance, soln, stop_token, cbk);
-            dckp_ienum::solve_dckp_ienum(instance, soln, stop_token, cbk);
+            // run the greedy portfolio to get a lower bound
+            dckp_ienum::solve_dckp_greedy_portfolio(instance, soln, stop_token, cbk);
+            dckp_ienum::solve_dckp_ienum(instance, soln, dckp_ienum::UpperBound::Fkp, stop_token, cbk);
+        },
+    },
+    {
+        "ienum-cliques", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::solve_dckp_greedy_portfolio(instance, soln, stop_token, cbk);
+            dckp_ienum::solve_dckp_ienum(instance, soln, dckp_ienum::UpperBound::CliqueFkp, stop_token, cbk);
         },
     },
     {
@@ -67,10 +128,27 @@ std::unordered_map<std::string, Solver> solvers {
             dckp_ienum::solve_dckp_hillclimb(instance, soln, stop_token, cbk);
         }
     },
+    {
+        "hillclimb-mt", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::HillclimbMtParams params;
+            params.num_threads = num_threads;
+            dckp_ienum::solve_dckp_hillclimb_mt(instance, soln, stop_token, cbk, params);
+        }
+    },
+    {
+        "tabu", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::solve_dckp_tabu(instance, soln, stop_token, cbk);
+        }
+    },
     {
         "greedy", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
             dckp_ienum::solve_dckp_greedy(instance, soln, stop_token, cbk);
         },
+    },
+    {
+        "greedy-portfolio", [](const dckp_ienum::Instance& instance, dckp_ienum::Solution& soln, std::atomic<bool>* stop_token, const SolutionCallback& cbk) {
+            dckp_ienum::solve_dckp_greedy_portfolio(instance, soln, stop_token, cbk);
+        },
     }
 };
 
@@ -99,6 +177,10 @@ std::optional<Arguments> parse_args(int argc, char* argv[]) {
         ("input", po::value(&ans.input), "input file")
         ("list,l", po::bool_switch(&ans.list), "instance list mode")
         ("output,o", po::value(&ans.output), "output file")
+        ("cache-dir", po::value(&ans.cache_dir), "directory of the binary cache of sorted instances")
+        ("threads", po::value(&num_threads)->default_value(0), "worker threads of the parallel solvers (0 = all hardware threads)")
+        ("bnb-memory", po::value(&bnb_memory_mb)->default_value(0), "memory budget of the open nodes of B&B in MB (0 = unlimited)")
+        ("probe", po::bool_switch(&ans.probe), "fix the items that probing against the greedy incumbent can, and solve the rest")
         ("timeout,t", po::value(&ans.timeout_s)->default_value(30), "timeout");
 
     // Positional arguments
@@ -154,11 +236,15 @@ void run_instance(const Arguments& args, const std::filesystem::path& root, cons
     std::cout << root / path << std::endl;
 
     dckp_ienum::Instance instance;
-    instance.parse(root / path);
-    instance.sort_items();
+    if (args.cache_dir.empty()) {
+        instance.parse(root / path);
+        instance.sort_items();
+    } else {
+        instance = dckp_ienum::InstanceCache(args.cache_dir).load(root / path);
+    }
 
     std::cout << "n: " << instance.num_items() << std::endl;
-    std::cout << "m: " << instance.conflicts().size() << std::endl;
+    std::cout << "m: " << instance.num_conflicts() << std::endl;
     std::cout << "c: " << instance.capacity() << std::endl;
 
     dckp_ienum::Solution solution;
@@ -197,11 +283,49 @@ void run_instance(const Arguments& args, const std::filesystem::path& root, cons
 
     std::chrono::steady_clock::time_point lb_timestamp = start;
     started.store(true);
-    (*args.solver)(instance, solution, &small_red_button, [&](const dckp_ienum::Solution& soln) {
+    SolutionCallback callback = [&](const dckp_ienum::Solution& soln) {
         lb_timestamp = std::chrono::steady_clock::now();
         dckp_ienum::solution_print(std::cout, soln, instance) << "\n\n";
         callback_time += std::chrono::steady_clock::now() - lb_timestamp;
-    });
+    };
+
+    if (args.probe) {
+        // Probe against the greedy incumbent, then only search for a better solution among the free items
+        dckp_ienum::solve_dckp_greedy_portfolio(instance, solution, &small_red_button, callback);
+
+        dckp_ienum::ProbingParams probing_params;
+        probing_params.num_threads = num_threads;
+        const dckp_ienum::ProbingResult probing = dckp_ienum::probe_items(instance, solution, probing_params);
+        std::cout << "probing: " << probing.fixed_in.count() << " fixed in, " << probing.num_fixed_out << " fixed out" << std::endl;
+
+        if (probing.closed) {
+            solution.ub = solution.p;
+        } else {
+            dckp_ienum::Solution reduced_solution;
+            reduced_solution.x.resize(probing.reduced.num_items(), false);
+
+            dckp_ienum::Solution expanded;
+            if (probing.reduced.num_items() > 0) {
+                (*args.solver)(probing.reduced, reduced_solution, &small_red_button, [&](const dckp_ienum::Solution& soln) {
+                    probing.expand(instance, soln, expanded);
+                    if (expanded.p > solution.p) {
+                        callback(expanded);
+                    }
+                });
+            } else {
+                reduced_solution.ub = 0;
+            }
+            probing.expand(instance, reduced_solution, expanded);
+
+            const dckp_ienum::int_profit_t ub = std::max(solution.p, expanded.ub);
+            if (expanded.p > solution.p) {
+                solution = std::move(expanded);
+            }
+            solution.ub = ub;
+        }
+    } else {
+        (*args.solver)(instance, solution, &small_red_button, callback);
+    }
     done.store(true);
 
     auto end = std::chrono::steady_clock::now();
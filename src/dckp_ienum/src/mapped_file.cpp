@@ -0,0 +1,67 @@
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dckp_ienum/mapped_file.hpp>
+
+namespace dckp_ienum {
+
+[[noreturn]] static void throw_errno(const char* what, const std::filesystem::path& path) {
+    std::ostringstream os;
+    os << what << " " << path << " failed: " << std::strerror(errno);
+    throw std::runtime_error(os.str());
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path, Access access) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw_errno("open", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw_errno("fstat", path);
+    }
+
+    // mmap refuses empty mappings, an empty file is just an empty view
+    m_size = static_cast<std::size_t>(st.st_size);
+    if (m_size > 0) {
+        void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw_errno("mmap", path);
+        }
+
+        ::madvise(addr, m_size, access == Access::Sequential ? MADV_SEQUENTIAL : MADV_WILLNEED);
+        m_data = static_cast<const char*>(addr);
+    }
+
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data != nullptr) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    m_data(std::exchange(other.m_data, nullptr)),
+    m_size(std::exchange(other.m_size, 0))
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    return *this;
+}
+
+} // namespace dckp_ienum
@@ -0,0 +1,45 @@
+#include <dckp_ienum/node_arena.hpp>
+
+namespace dckp_ienum {
+
+node_index_t NodeArena::push(node_index_t previous, item_index_t item) {
+    acquire(previous);
+
+    const Record record { previous, item, 1 };
+    if (m_free.empty()) {
+        m_records.push_back(record);
+        return static_cast<node_index_t>(m_records.size() - 1);
+    }
+
+    const node_index_t path = m_free.back();
+    m_free.pop_back();
+    m_records[path] = record;
+    return path;
+}
+
+node_index_t NodeArena::push(const Bitset& x) {
+    node_index_t path = empty;
+    x.for_each([&](item_index_t item) {
+        // The new record holds the only reference to the previous one
+        const node_index_t next = push(path, item);
+        release(path);
+        path = next;
+    });
+    return path;
+}
+
+void NodeArena::release(node_index_t path) {
+    while (path != empty && --m_records[path].refs == 0) {
+        m_free.push_back(path);
+        path = m_records[path].previous;
+    }
+}
+
+void NodeArena::path(node_index_t path, Bitset& x) const {
+    x.reset();
+    for (; path != empty; path = m_records[path].previous) {
+        x.set(m_records[path].item);
+    }
+}
+
+} // namespace dckp_ienum
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <limits>
+
+#include <dckp_ienum/probing.hpp>
+#include <dckp_ienum/profiler.hpp>
+#include <dckp_ienum/thread_pool.hpp>
+
+namespace dckp_ienum {
+
+namespace {
+
+// None: neither taking nor leaving the item out leads to a solution better than the incumbent
+enum class Fixing : std::uint8_t { Free, In, Out, None };
+
+// Stamps instead of clearing: excluded[i] == epoch if item i is left out of the current probe
+struct ProbeWorkspace {
+    std::vector<std::uint32_t> excluded;
+    std::uint32_t epoch = 0;
+
+    std::uint32_t next_epoch() {
+        if (++epoch == 0) {
+            std::fill(excluded.begin(), excluded.end(), 0);
+            epoch = 1;
+        }
+        return epoch;
+    }
+};
+
+struct DantzigBound {
+    profit_sum_t ub;
+    std::size_t critical;     // position in the free items of the fractional item (free.size() if everything fits)
+};
+
+// Dantzig bound of the free items (in p/w order) that are not excluded and weigh at most capacity
+DantzigBound dantzig_bound(const Instance& instance, const std::vector<item_index_t>& free, const ProbeWorkspace& workspace, int_weight_t capacity) {
+    profit_sum_t profit = 0;
+    int_weight_t residual = capacity;
+    for (std::size_t k = 0; k < free.size(); ++k) {
+        const item_index_t i = free[k];
+        if (workspace.excluded[i] == workspace.epoch || instance.weight(i) > capacity) {
+            continue;
+        }
+        if (instance.weight(i) > residual) {
+            return { profit + profit_sum_t(instance.profit(i)) * residual / instance.weight(i), k };
+        }
+        residual -= instance.weight(i);
+        profit += instance.profit(i);
+    }
+    return { profit, free.size() };
+}
+
+} // namespace
+
+void ProbingResult::expand(const Instance& instance, const Solution& reduced_soln, Solution& soln) const {
+    soln.x = fixed_in;
+    reduced_soln.x.for_each([&](item_index_t r) {
+        soln.x.set(instance.o2s_index(reduced.s2o_index(r)));
+    });
+    soln.p = fixed_p + reduced_soln.p;
+    soln.w = fixed_w + reduced_soln.w;
+    soln.ub = reduced_soln.ub == std::numeric_limits<int_profit_t>::max()? reduced_soln.ub : fixed_p + reduced_soln.ub;
+}
+
+ProbingResult probe_items(const Instance& instance, const Solution& incumbent, const ProbingParams& params) {
+    profiler::ScopedTicToc tictoc("probe_items");
+
+    const item_index_t n = instance.num_items();
+
+    ProbingResult ans;
+    ans.fixed_in.resize(n);
+
+    std::vector<Fixing> fixing(n, Fixing::Free);
+    std::vector<Fixing> verdict(n, Fixing::Free);
+    std::vector<item_index_t> free;
+
+    unsigned num_threads = params.num_threads > 0? params.num_threads : ThreadPool::hardware_threads();
+    ThreadPool pool(num_threads);
+    std::vector<ProbeWorkspace> workspaces(pool.num_threads() * 4);
+    for (auto& workspace : workspaces) {
+        workspace.excluded.assign(n, 0);
+    }
+
+    // Take item i, leaving its neighbours out. False if no solution better than the incumbent is left.
+    auto fix_in = [&](item_index_t i) {
+        if (fixing[i] == Fixing::Out || instance.weight(i) > instance.capacity() - ans.fixed_w) {
+            return false;
+        }
+        fixing[i] = Fixing::In;
+        ans.fixed_in.set(i);
+        ans.fixed_p += instance.profit(i);
+        ans.fixed_w += instance.weight(i);
+        for (item_index_t j : instance.conflicts(i)) {
+            if (fixing[j] == Fixing::In) {
+                return false;
+            }
+            fixing[j] = Fixing::Out;
+        }
+        return true;
+    };
+
+    for (unsigned round = 0; round < params.max_rounds && not ans.closed; ++round) {
+        profiler::ScopedTicToc tictoc("probe_items_round");
+
+        // The items that no longer fit are out
+        const int_weight_t residual = instance.capacity() - ans.fixed_w;
+        free.clear();
+        for (item_index_t i = 0; i < n; ++i) {
+            if (fixing[i] == Fixing::Free && instance.weight(i) > residual) {
+                fixing[i] = Fixing::Out;
+            }
+            if (fixing[i] == Fixing::Free) {
+                free.push_back(i);
+            }
+        }
+
+        ProbeWorkspace& root_workspace = workspaces.front();
+        root_workspace.next_epoch();
+        const DantzigBound root = dantzig_bound(instance, free, root_workspace, residual);
+        if (ans.fixed_p + root.ub <= incumbent.p) {
+            ans.closed = true;
+            break;
+        }
+
+        // Each chunk of the free items is probed with its own workspace
+        const std::size_t num_chunks = std::min(workspaces.size(), free.size());
+        std::vector<std::future<void>> futures;
+        futures.reserve(num_chunks);
+        for (std::size_t c = 0; c < num_chunks; ++c) {
+            futures.push_back(pool.submit([&, c]() {
+                ProbeWorkspace& workspace = workspaces[c];
+                for (std::size_t k = c; k < free.size(); k += num_chunks) {
+                    const item_index_t i = free[k];
+                    verdict[i] = Fixing::Free;
+
+                    // Taken, without its neighbours
+                    const std::uint32_t epoch = workspace.next_epoch();
+                    workspace.excluded[i] = epoch;
+                    for (item_index_t j : instance.conflicts(i)) {
+                        workspace.excluded[j] = epoch;
+                    }
+                    const profit_sum_t ub_in = ans.fixed_p + instance.profit(i) + dantzig_bound(instance, free, workspace, residual - instance.weight(i)).ub;
+                    if (ub_in <= incumbent.p) {
+                        verdict[i] = Fixing::Out;
+                    }
+
+                    // Left out: only the items up to the critical one change the root bound
+                    if (k <= root.critical) {
+                        workspace.excluded[i] = workspace.next_epoch();
+                        const profit_sum_t ub_out = ans.fixed_p + dantzig_bound(instance, free, workspace, residual).ub;
+                        if (ub_out <= incumbent.p) {
+                            verdict[i] = verdict[i] == Fixing::Out? Fixing::None : Fixing::In;
+                        }
+                    }
+                }
+            }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+
+        // Every verdict holds on its own, so they are all applied at once
+        bool changed = false;
+        for (item_index_t i : free) {
+            if (ans.closed) {
+                break;
+            }
+            if (verdict[i] == Fixing::None) {
+                ans.closed = true;
+            } else if (verdict[i] == Fixing::Out && fixing[i] == Fixing::Free) {
+                fixing[i] = Fixing::Out;
+                changed = true;
+            } else if (verdict[i] == Fixing::In) {
+                ans.closed = not fix_in(i);
+                changed = true;
+            }
+        }
+        if (not changed) {
+            break;
+        }
+    }
+
+    std::vector<item_index_t> items;
+    if (not ans.closed) {
+        for (item_index_t i = 0; i < n; ++i) {
+            if (fixing[i] == Fixing::Free) {
+                items.push_back(i);
+            }
+        }
+    }
+    ans.num_fixed_out = static_cast<item_index_t>(std::count(fixing.begin(), fixing.end(), Fixing::Out));
+    ans.reduced = instance.subinstance(items, ans.closed? 0 : instance.capacity() - ans.fixed_w);
+
+    return ans;
+}
+
+} // namespace dckp_ienum
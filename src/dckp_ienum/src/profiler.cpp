@@ -14,7 +14,8 @@ namespace profiler {
 
 #ifdef ENABLE_PROFILING
 
-static std::unordered_map<std::string_view, Stats> data;
+// Per thread, so that the threads of the parallel solvers do not race. Only the calling thread's are printed.
+static thread_local std::unordered_map<std::string_view, Stats> data;
 
 inline static Stats& get_or_create_stats(std::string_view name) {
     return data.try_emplace(name, name).first->second;
@@ -0,0 +1,71 @@
+#include <thread>
+
+#include <dckp_ienum/shared_incumbent.hpp>
+
+namespace dckp_ienum {
+
+SharedIncumbent::SharedIncumbent(std::size_t num_items) :
+    m_size(num_items),
+    m_num_words(Bitset::num_words(num_items)),
+    m_words(new std::atomic<word_t>[m_num_words])
+{
+    for (std::size_t k = 0; k < m_num_words; ++k) {
+        m_words[k].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool SharedIncumbent::publish(const Solution& soln) {
+    while (true) {
+        if (soln.p <= profit()) {
+            return false;
+        }
+
+        // Enter the write section: even -> odd
+        std::uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) || not m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // Another writer may have published a better solution in the meantime
+        bool better = soln.p > m_profit.load(std::memory_order_relaxed);
+        if (better) {
+            const word_t* words = soln.x.data();
+            for (std::size_t k = 0; k < m_num_words; ++k) {
+                m_words[k].store(words[k], std::memory_order_relaxed);
+            }
+            m_weight.store(soln.w, std::memory_order_relaxed);
+            m_profit.store(soln.p, std::memory_order_release);
+        }
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+        return better;
+    }
+}
+
+void SharedIncumbent::read(Solution& soln) const {
+    soln.x.resize(m_size);
+    word_t* words = soln.x.data();
+
+    while (true) {
+        std::uint64_t before = m_sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        for (std::size_t k = 0; k < m_num_words; ++k) {
+            words[k] = m_words[k].load(std::memory_order_relaxed);
+        }
+        soln.w = m_weight.load(std::memory_order_relaxed);
+        soln.p = m_profit.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == before) {
+            return;
+        }
+    }
+}
+
+} // namespace dckp_ienum
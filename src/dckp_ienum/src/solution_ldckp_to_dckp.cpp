@@ -14,17 +14,19 @@ void solution_ldckp_to_dckp(const dckp_ienum::Instance& instance, const Eigen::A
     // solution.ub = std::min(solution.ub, static_cast<int_profit_t>(result.L_opt));
 
     // Satisfy conflict constraints by dropping items
-    for (const InstanceConflict& conflict : instance.conflicts()) {
-        // If this constraint is unsatisfied
-        if (solution.x(conflict.i) && solution.x(conflict.j)) {
-            // Greedily choose which to keep by comparing costs.
-
-            const auto profit_i = instance.profit(conflict.i);
-            const auto profit_j = instance.profit(conflict.j);
-            
-            const auto todrop = profit_i < profit_j? conflict.i : conflict.j;
-
-            solution.x(todrop) = false;
+    for (item_index_t i = 0; i < instance.num_items(); ++i) {
+        for (item_index_t j : instance.forward_conflicts(i)) {
+            // If this constraint is unsatisfied
+            if (solution.x(i) && solution.x(j)) {
+                // Greedily choose which to keep by comparing costs.
+
+                const auto profit_i = instance.profit(i);
+                const auto profit_j = instance.profit(j);
+                
+                const auto todrop = profit_i < profit_j? i : j;
+
+                solution.x(todrop) = false;
+            }
         }
     }
 
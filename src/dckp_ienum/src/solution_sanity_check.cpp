@@ -10,12 +10,10 @@ namespace dckp_ienum {
 void solution_sanity_check(const Solution& solution, const dckp_ienum::Instance& instance, bool check_conflicts) {
     int_profit_t profit = 0;
     int_weight_t weight = 0;
-    for (item_index_t i = 0; i < instance.num_items(); ++i) {
-        if (solution.x[i]) {
-            profit += instance.profit(i);
-            weight += instance.weight(i);
-        }
-    }
+    solution.x.for_each([&](item_index_t i) {
+        profit += instance.profit(i);
+        weight += instance.weight(i);
+    });
 
     bool has_conflicts = check_conflicts && solution_has_conflicts(instance, solution.x);
 
@@ -0,0 +1,35 @@
+#include <algorithm>
+
+#include <dckp_ienum/solution_state.hpp>
+
+namespace dckp_ienum {
+
+SolutionState::SolutionState(const Instance& instance, Solution& soln) :
+    m_instance(&instance),
+    m_soln(&soln),
+    m_blocked(instance.num_items(), 0),
+    m_blockers(instance.num_items(), 0)
+{
+    sync();
+}
+
+void SolutionState::sync() {
+    std::fill(m_blocked.begin(), m_blocked.end(), 0);
+    std::fill(m_blockers.begin(), m_blockers.end(), 0);
+    m_soln->x.for_each([&](item_index_t i) {
+        for (item_index_t j : m_instance->conflicts(i)) {
+            ++m_blocked[j];
+            m_blockers[j] ^= i;
+        }
+    });
+}
+
+void SolutionState::clear() {
+    m_soln->x.reset();
+    m_soln->p = 0;
+    m_soln->w = 0;
+    std::fill(m_blocked.begin(), m_blocked.end(), 0);
+    std::fill(m_blockers.begin(), m_blockers.end(), 0);
+}
+
+} // namespace dckp_ienum
@@ -0,0 +1,60 @@
+#include <dckp_ienum/thread_pool.hpp>
+
+namespace dckp_ienum {
+
+unsigned ThreadPool::hardware_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0? n : 1;
+}
+
+ThreadPool::ThreadPool(unsigned num_threads) {
+    if (num_threads == 0) {
+        num_threads = hardware_threads();
+    }
+
+    m_workers.reserve(num_threads);
+    for (unsigned k = 0; k < num_threads; ++k) {
+        m_workers.emplace_back([this]() { run_worker(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task) {
+    std::packaged_task<void()> packaged(std::move(task));
+    auto future = packaged.get_future();
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push_back(std::move(packaged));
+    }
+    m_cv.notify_one();
+    return future;
+}
+
+void ThreadPool::run_worker() {
+    while (true) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_stopping || not m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace dckp_ienum